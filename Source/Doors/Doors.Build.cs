@@ -17,6 +17,8 @@ public class Doors : ModuleRules
 				"DeveloperSettings",
 				"TargetingSystem",
 				"Grasp",
+				"NavigationSystem",
+				"Chaos",
 			}
 			);
 			
@@ -26,7 +28,9 @@ public class Doors : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"AIModule",
 				"NetCore",
+				"PhysicsCore",
 				"UMG",
 			}
 			);
@@ -10,7 +10,21 @@
 #include "Engine/World.h"
 #include "TimerManager.h"
 #include "System/DoorVersioning.h"
+#include "System/DoorInteractionSubsystem.h"
+#include "System/DoorRewindSubsystem.h"
+#include "System/DoorSpatialSubsystem.h"
+#include "System/DoorPortalSubsystem.h"
+#include "System/DoorOccupancySubsystem.h"
+#include "System/DoorProximitySubsystem.h"
+#include "System/DoorPushSubsystem.h"
+#include "System/DoorAsyncPhysicsSubsystem.h"
+#include "Navigation/DoorNavLinkComponent.h"
+#include "PhysicsEngine/PhysicsConstraintComponent.h"
 #include "DoorTags.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerState.h"
 
 #if WITH_EDITORONLY_DATA
 #include "Visualizers/DoorEditorVisualizer.h"
@@ -52,7 +66,16 @@ TArray<FGameplayAbilityTargetData*> ADoor::GatherOptionalGraspTargetData(const F
 		const EDoorState CurrentDoorState = GetDoorState();
 		const EDoorDirection CurrentDoorDirection = GetDoorDirection();
 		const EDoorSide CurrentDoorSide = GetDoorSide(AvatarActor);
-		auto* DoorTargetData = new FDoorAbilityTargetData(CurrentDoorState, CurrentDoorDirection, CurrentDoorSide);
+
+		// Server time allows the server to rewind when validating our door side
+		const AGameStateBase* GameState = GetWorld()->GetGameState();
+		const float ClientTimestamp = GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
+		
+		// Identify our prediction so the server can echo it back with the replicated door state
+		const uint8 PredictionId = GeneratePredictionId();
+		
+		auto* DoorTargetData = new FDoorAbilityTargetData(CurrentDoorState, CurrentDoorDirection, CurrentDoorSide,
+			ClientTimestamp, PredictionId);
 		return { DoorTargetData };
 	}
 	return {};
@@ -72,6 +95,18 @@ ADoor::ADoor(const FObjectInitializer& ObjectInitializer)
 
 	Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
 	SetRootComponent(Root);
+
+	// Navigation links through the door, one per side to allow one-way access
+	NavLinkFront = CreateOptionalDefaultSubobject<UDoorNavLinkComponent>(TEXT("NavLinkFront"));
+	if (NavLinkFront)
+	{
+		NavLinkFront->FromSide = EDoorSide::Front;
+	}
+	NavLinkBack = CreateOptionalDefaultSubobject<UDoorNavLinkComponent>(TEXT("NavLinkBack"));
+	if (NavLinkBack)
+	{
+		NavLinkBack->FromSide = EDoorSide::Back;
+	}
 	
 #if WITH_EDITORONLY_DATA
 	// Draw editor visualization
@@ -101,9 +136,30 @@ void ADoor::BeginPlay()
 
 	UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::BeginPlay Initialize Alpha: %.2f, %s"), *GetRoleString(), DoorAlpha, *GetName());
 
+	// Physics doors are moved by their constraint
+	if (DoorAlphaMode == EAlphaMode::Physics)
+	{
+		InitDoorPhysics();
+	}
+
+	// Fixed doors are stepped by the deterministic simulation
+	if (DoorAlphaMode == EAlphaMode::Fixed)
+	{
+		InitFixedSim();
+	}
+
 	// Initialize the position of the door
 	OnDoorStateChanged(DoorState, DoorState, DoorDirection, DoorDirection, nullptr, false);
 
+	// Move in the physics step instead of on tick
+	if (bAsyncDoorMotion && (DoorAlphaMode == EAlphaMode::Time || DoorAlphaMode == EAlphaMode::InterpConstant))
+	{
+		if (UDoorAsyncPhysicsSubsystem* AsyncPhysicsSubsystem = GetWorld()->GetSubsystem<UDoorAsyncPhysicsSubsystem>())
+		{
+			bAsyncDoorMotionActive = AsyncPhysicsSubsystem->RegisterDoor(this);
+		}
+	}
+
 	// Initialize the alpha -- OnDoorStateChanged won't do this for these specific states
 	switch (DoorState)
 	{
@@ -126,12 +182,128 @@ void ADoor::BeginPlay()
 		DoorCVars::CVarShowDoorStateDuringPIE->SetOnChangedCallback(ShowDoorStateDuringPIEDelegate);
 	}
 #endif
+
+	// Start at the rate for our initial state, placing the door is not activity that needs replicating quickly
+	if (HasAuthority() && bAdaptiveNetUpdateFrequency && GetNetMode() != NM_Standalone)
+	{
+		GetWorldTimerManager().ClearTimer(NetActiveLingerTimerHandle);
+		ApplyNetUpdateRate(IsDoorNetActive());
+	}
+
+	// Register with the spatial index so we can be found without physics queries
+	if (UDoorSpatialSubsystem* SpatialSubsystem = GetWorld()->GetSubsystem<UDoorSpatialSubsystem>())
+	{
+		SpatialSubsystem->RegisterDoor(this);
+	}
+
+	// Open and close automatically when pawns are nearby
+	if (ShouldRunAutoDoor())
+	{
+		if (UDoorProximitySubsystem* ProximitySubsystem = GetWorld()->GetSubsystem<UDoorProximitySubsystem>())
+		{
+			ProximitySubsystem->RegisterDoor(this);
+		}
+	}
+
+	// Act as a portal between rooms for visibility culling
+	if (UDoorPortalSubsystem* PortalSubsystem = GetWorld()->GetSubsystem<UDoorPortalSubsystem>())
+	{
+		PortalSubsystem->RegisterDoor(this);
+	}
+
+	// Keep the door side plane and spatial index up to date when we move
+	InvalidateDoorSidePlane();
+	if (RootComponent)
+	{
+		RootComponent->TransformUpdated.AddUObject(this, &ThisClass::OnDoorTransformUpdated);
+	}
+
+	// Record our history so the server can rewind when validating the client's door side
+	if (HasAuthority() && !bTrustClientDoorSide)
+	{
+		if (UDoorRewindSubsystem* RewindSubsystem = GetWorld()->GetSubsystem<UDoorRewindSubsystem>())
+		{
+			RewindSubsystem->RegisterDoor(this);
+		}
+	}
+}
+
+void ADoor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UDoorRewindSubsystem* RewindSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UDoorRewindSubsystem>() : nullptr)
+	{
+		RewindSubsystem->UnregisterDoor(this);
+	}
+
+	if (UDoorSpatialSubsystem* SpatialSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UDoorSpatialSubsystem>() : nullptr)
+	{
+		SpatialSubsystem->UnregisterDoor(this);
+	}
+
+	if (UDoorPortalSubsystem* PortalSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UDoorPortalSubsystem>() : nullptr)
+	{
+		PortalSubsystem->UnregisterDoor(this);
+	}
+
+	if (UDoorProximitySubsystem* ProximitySubsystem = GetWorld() ? GetWorld()->GetSubsystem<UDoorProximitySubsystem>() : nullptr)
+	{
+		ProximitySubsystem->UnregisterDoor(this);
+	}
+
+	if (UDoorPushSubsystem* PushSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UDoorPushSubsystem>() : nullptr)
+	{
+		PushSubsystem->UnregisterDoor(this);
+	}
+
+	if (UDoorAsyncPhysicsSubsystem* AsyncPhysicsSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UDoorAsyncPhysicsSubsystem>() : nullptr)
+	{
+		AsyncPhysicsSubsystem->UnregisterDoor(this);
+	}
+	bAsyncDoorMotionActive = false;
+
+	if (RootComponent)
+	{
+		RootComponent->TransformUpdated.RemoveAll(this);
+	}
+	
+	Super::EndPlay(EndPlayReason);
+}
+
+void ADoor::OnDoorTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags,
+	ETeleportType Teleport)
+{
+	InvalidateDoorSidePlane();
+	
+	if (UDoorSpatialSubsystem* SpatialSubsystem = GetWorld()->GetSubsystem<UDoorSpatialSubsystem>())
+	{
+		SpatialSubsystem->UpdateDoor(this);
+	}
+
+	if (UDoorPortalSubsystem* PortalSubsystem = GetWorld()->GetSubsystem<UDoorPortalSubsystem>())
+	{
+		PortalSubsystem->UpdateDoorRooms(this);
+	}
+
+	if (UDoorProximitySubsystem* ProximitySubsystem = GetWorld()->GetSubsystem<UDoorProximitySubsystem>())
+	{
+		ProximitySubsystem->UpdateDoor(this);
+	}
+
+	if (bAsyncDoorMotionActive)
+	{
+		if (UDoorAsyncPhysicsSubsystem* AsyncPhysicsSubsystem = GetWorld()->GetSubsystem<UDoorAsyncPhysicsSubsystem>())
+		{
+			AsyncPhysicsSubsystem->UpdateDoor(this);
+		}
+	}
 }
 
 void ADoor::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	TickRepDoorAlpha();
+	
 	TickDoor(DeltaTime);
 
 #if UE_ENABLE_DEBUG_DRAWING && WITH_EDITOR
@@ -148,6 +320,29 @@ void ADoor::Tick(float DeltaTime)
 
 void ADoor::TickDoor_Implementation(float DeltaTime)
 {
+	// A pawn stepped into the doorway while closing
+	if (DoorState == EDoorState::Closing && DoorwayOccupiedResponse != EDoorOccupiedResponse::Refuse &&
+		ShouldDoorwayBlockClosing())
+	{
+		// Clients hold the door until the server's reversal replicates
+		if (DoorwayOccupiedResponse == EDoorOccupiedResponse::Reverse && HasAuthority())
+		{
+			SetDoorState(EDoorState::Opening, DoorDirection, nullptr);
+		}
+		else
+		{
+			SetDoorwayHold(true);
+			return;
+		}
+	}
+	SetDoorwayHold(false);
+	
+	// The physics step moves the door
+	if (bAsyncDoorMotionActive)
+	{
+		return;
+	}
+	
 	const float TargetAlpha = GetTargetDoorAlpha();
 
 	switch (DoorAlphaMode)
@@ -208,7 +403,162 @@ void ADoor::TickDoor_Implementation(float DeltaTime)
 		break;
 	case EAlphaMode::Disabled:
 		break;
+	case EAlphaMode::Fixed:
+		{
+			// Only whole ticks are simulated, the frame rate decides when they run but never what they produce
+			const float TickInterval = 1.f / FDoorFixedSim::GetTicksPerSecond();
+			FixedSimAccumulator += DeltaTime;
+			const int32 NumTicks = FMath::FloorToInt32(FixedSimAccumulator / TickInterval);
+			FixedSimAccumulator -= NumTicks * TickInterval;
+			StepFixedSim(NumTicks);
+		}
+		break;
+	case EAlphaMode::Physics:
+		{
+			// Settled doors keep their exact alpha, the motor holds them in place
+			if (!IsDoorInMotion())
+			{
+				break;
+			}
+			
+			// The motor drives the leaf, we only read it back
+			const float NewAlpha = GetDoorPhysicsAlpha();
+			const float AlphaSpeed = DeltaTime > 0.f ? FMath::Abs(NewAlpha - DoorAlpha) / DeltaTime : 0.f;
+			if (FMath::IsNearlyEqual(NewAlpha, TargetAlpha, DoorPhysicsTolerance) && AlphaSpeed <= DoorPhysicsSettleSpeed)
+			{
+				// Finish the transition so the usual events fire, then stop paying for the leaf in the physics scene
+				SetDoorAlpha(TargetAlpha);
+				if (UPrimitiveComponent* Leaf = GetDoorLeaf())
+				{
+					Leaf->PutAllRigidBodiesToSleep();
+				}
+			}
+			else
+			{
+				SetDoorAlpha(NewAlpha);
+			}
+		}
+		break;
+	}
+}
+
+void ADoor::InitFixedSim()
+{
+	FixedSim.Params = FDoorFixedSimParams::Make(DoorOpenOutwardTime, DoorOpenInwardTime, DoorCloseOutwardTime,
+		DoorCloseInwardTime, FDoorFixedSim::GetTicksPerSecond(), DoorFixedEasing);
+	
+	FixedSim.State = FDoorFixedSimState();
+	FixedSim.State.DoorState = DoorState;
+	FixedSim.State.DoorDirection = DoorDirection;
+	FixedSim.State.Phase = FDoorFixedSim::FromFloat(DoorAlpha);
+	FixedSimAccumulator = 0.f;
+}
+
+void ADoor::StepFixedSim(int32 NumTicks)
+{
+	for (int32 i = 0; i < NumTicks; i++)
+	{
+		FixedSim.Step();
+	}
+
+	// Reaches exactly 0 or 1, which finishes the transition without relying on tolerances
+	SetDoorAlpha(FDoorFixedSim::ToFloat(FixedSim.GetAlpha()));
+}
+
+void ADoor::RestoreFixedSimState(const FDoorFixedSimState& SimState)
+{
+	FixedSim.State = SimState;
+	FixedSimAccumulator = 0.f;
+	SetDoorState(SimState.DoorState, SimState.DoorDirection, nullptr, true);
+	SetDoorAlpha(FDoorFixedSim::ToFloat(FixedSim.GetAlpha()));
+}
+
+void ADoor::InitDoorPhysics()
+{
+	UPhysicsConstraintComponent* Constraint = GetDoorPhysicsConstraint();
+	if (!Constraint)
+	{
+		UE_LOG(LogDoors, Warning, TEXT("%s ADoor::InitDoorPhysics: %s uses EAlphaMode::Physics without a constraint, override GetDoorPhysicsConstraint()"),
+			*GetRoleString(), *GetName());
+		return;
+	}
+
+	switch (DoorPhysicsJoint)
+	{
+	case EDoorPhysicsJoint::Hinge:
+		Constraint->SetAngularDriveMode(EAngularDriveMode::TwistAndSwing);
+		Constraint->SetAngularOrientationDrive(true, false);
+		Constraint->SetAngularDriveParams(DoorPhysicsDriveStrength, DoorPhysicsDriveDamping, DoorPhysicsMaxForce);
+		break;
+	case EDoorPhysicsJoint::Prismatic:
+		Constraint->SetLinearPositionDrive(true, false, false);
+		Constraint->SetLinearDriveParams(DoorPhysicsDriveStrength, DoorPhysicsDriveDamping, DoorPhysicsMaxForce);
+		if (const UPrimitiveComponent* Leaf = GetDoorLeaf())
+		{
+			const FVector Local = Constraint->GetComponentTransform().InverseTransformPositionNoScale(Leaf->GetComponentLocation());
+			DoorPhysicsClosedOffset = Local.X - DoorAlpha * DoorPhysicsOpenDistance;
+		}
+		break;
+	}
+
+	UpdateDoorPhysicsTarget(true);
+}
+
+void ADoor::UpdateDoorPhysicsTarget(bool bForce)
+{
+	// Hold the leaf where it is while a pawn is in the doorway
+	const float TargetAlpha = bDoorwayHold ? GetDoorPhysicsAlpha() : GetTargetDoorAlpha();
+	if (TargetAlpha == DoorPhysicsTargetAlpha && !bForce)
+	{
+		return;
+	}
+	DoorPhysicsTargetAlpha = TargetAlpha;
+
+	UPhysicsConstraintComponent* Constraint = GetDoorPhysicsConstraint();
+	if (!Constraint)
+	{
+		return;
+	}
+
+	switch (DoorPhysicsJoint)
+	{
+	case EDoorPhysicsJoint::Hinge:
+		Constraint->SetAngularOrientationTarget(FRotator(0.f, TargetAlpha * DoorPhysicsOpenAngle, 0.f));
+		break;
+	case EDoorPhysicsJoint::Prismatic:
+		Constraint->SetLinearPositionTarget(FVector(TargetAlpha * DoorPhysicsOpenDistance, 0.f, 0.f));
+		break;
+	}
+
+	// The leaf may be asleep from settling at the previous target
+	if (UPrimitiveComponent* Leaf = GetDoorLeaf())
+	{
+		Leaf->WakeAllRigidBodies();
+	}
+}
+
+float ADoor::GetDoorPhysicsAlpha() const
+{
+	const UPhysicsConstraintComponent* Constraint = GetDoorPhysicsConstraint();
+	if (!Constraint)
+	{
+		return DoorAlpha;
+	}
+
+	switch (DoorPhysicsJoint)
+	{
+	case EDoorPhysicsJoint::Hinge:
+		// The constraint reports radians, the open angle and drive target are degrees
+		return FMath::Clamp<float>(FMath::RadiansToDegrees(Constraint->GetCurrentSwing1()) / DoorPhysicsOpenAngle, -1.f, 1.f);
+	case EDoorPhysicsJoint::Prismatic:
+		if (const UPrimitiveComponent* Leaf = GetDoorLeaf())
+		{
+			const FVector Local = Constraint->GetComponentTransform().InverseTransformPositionNoScale(Leaf->GetComponentLocation());
+			return FMath::Clamp<float>((Local.X - DoorPhysicsClosedOffset) / DoorPhysicsOpenDistance, -1.f, 1.f);
+		}
+		break;
 	}
+	return DoorAlpha;
 }
 
 float ADoor::GetTargetDoorAlpha() const
@@ -253,25 +603,117 @@ void ADoor::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifet
 	SharedParams.bIsPushBased = true;
 	SharedParams.Condition = COND_None;
 	
-	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, DoorAccess, SharedParams);
-	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, DoorOpenDirection, SharedParams);
-	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, DoorOpenMotion, SharedParams);
-
-	// We make the LastAvatar the owner for a short time so they don't fight the prediction
-	SharedParams.Condition = COND_SkipOwner;
+	// Door state, access, open direction and open motion are packed together
+	// Predicting clients reconcile using the PredictionId packed into the door state
 	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, RepDoorState, SharedParams);
+
+	// Only marked dirty while the door is moving, if bReplicateDoorAlpha is enabled
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, RepDoorAlpha, SharedParams);
 }
 
 // -------------------------------------------------------------
 // Door State
 
-void ADoor::OnRep_DoorState()
+void ADoor::OnRep_DoorState(uint32 OldRepDoorState)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(ADoor::OnRep_DoorState);
 
-	EDoorState NewDoorState;
-	EDoorDirection NewDoorDirection;
-	UDoorStatics::UnpackDoorState(RepDoorState, NewDoorState, NewDoorDirection);
+	FDoorRepState RepState;
+	if (!UDoorStatics::UnpackRepDoorState(RepDoorState, RepState))
+	{
+		UE_LOG(LogDoors, Warning, TEXT("%s ADoor::OnRep_DoorState: Discarding door state with mismatched layout version %u, expected %u"),
+			*GetRoleString(), (RepDoorState >> 28) & 0xF, DoorRepStateVersion);
+		return;
+	}
+
+	// A previous state with a mismatched version never applied, treat everything as changed
+	FDoorRepState OldRepState;
+	const bool bHasOldRepState = UDoorStatics::UnpackRepDoorState(OldRepDoorState, OldRepState);
+
+	// Door state first, access changes are applied by the server after the door state changes
+	if (!bHasOldRepState || RepState.HasDoorStateChanged(OldRepState))
+	{
+		ReconcileRepDoorState(RepState);
+	}
+
+	if (DoorAccess != RepState.DoorAccess)
+	{
+		const EDoorAccess OldDoorAccess = DoorAccess;
+		DoorAccess = RepState.DoorAccess;
+		OnDoorAccessChanged(OldDoorAccess, DoorAccess);
+	}
+
+	if (DoorOpenDirection != RepState.DoorOpenDirection)
+	{
+		const EDoorOpenDirection OldDoorOpenDirection = DoorOpenDirection;
+		DoorOpenDirection = RepState.DoorOpenDirection;
+		OnDoorOpenDirectionChanged(OldDoorOpenDirection, DoorOpenDirection);
+	}
+
+	if (DoorOpenMotion != RepState.DoorOpenMotion)
+	{
+		const EDoorMotion OldDoorOpenMotion = DoorOpenMotion;
+		DoorOpenMotion = RepState.DoorOpenMotion;
+		OnDoorOpenMotionChanged(OldDoorOpenMotion, DoorOpenMotion);
+	}
+}
+
+void ADoor::ReconcileRepDoorState(const FDoorRepState& RepState)
+{
+	const EDoorState NewDoorState = RepState.DoorState;
+	const EDoorDirection NewDoorDirection = RepState.DoorDirection;
+	const uint8 PredictionId = RepState.PredictionId;
+	const uint16 PredictionOwner = RepState.PredictionOwner;
+
+	// Reconcile our predictions
+	if (!PendingPredictions.IsEmpty())
+	{
+		const int32 Index = PredictionId == 0 ? INDEX_NONE : PendingPredictions.IndexOfByPredicate(
+			[PredictionId, PredictionOwner](const FDoorPredictedState& Prediction)
+			{
+				return Prediction.IsCausedBy(PredictionId, PredictionOwner);
+			});
+
+		// Not a response to our prediction, hold it until our prediction is acknowledged or times out
+		if (Index == INDEX_NONE)
+		{
+			UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::OnRep_DoorState: Holding %s while predicting"), *GetRoleString(),
+				*UDoorStatics::DoorStateDirectionToString(NewDoorState, NewDoorDirection));
+			return;
+		}
+
+		// The server agrees with our prediction, we're already simulating it
+		if (PendingPredictions[Index].IsAcknowledgedBy(NewDoorState, NewDoorDirection))
+		{
+			PendingPredictions.RemoveAt(0, Index + 1);
+			if (PendingPredictions.IsEmpty())
+			{
+				GetWorldTimerManager().ClearTimer(PredictionTimeoutTimerHandle);
+			}
+			return;
+		}
+
+		// The server accepted our interaction but resolved it differently, roll back to the server's state
+		UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::OnRep_DoorState: Prediction mismatch, predicted %s, server %s"), *GetRoleString(),
+			*UDoorStatics::DoorStateDirectionToString(PendingPredictions[Index].DoorState, PendingPredictions[Index].DoorDirection),
+			*UDoorStatics::DoorStateDirectionToString(NewDoorState, NewDoorDirection));
+		
+		PendingPredictions.Reset();
+		GetWorldTimerManager().ClearTimer(PredictionTimeoutTimerHandle);
+	}
+
+	// We opened this auto door locally and the server hasn't caught up yet, don't close it on our pawn
+	if (IsDoorStateClosedOrClosing(NewDoorState) && bAutoDoor && bAutoDoorClientPredicted && !HasAuthority())
+	{
+		const UDoorProximitySubsystem* ProximitySubsystem = GetWorld()->GetSubsystem<UDoorProximitySubsystem>();
+		if (ProximitySubsystem && ProximitySubsystem->IsAutoDoorPredicting(this))
+		{
+			UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::OnRep_DoorState: Holding %s while predicting auto door"), *GetRoleString(),
+				*UDoorStatics::DoorStateDirectionToString(NewDoorState, NewDoorDirection));
+			return;
+		}
+	}
+	
 	SetDoorState(NewDoorState, NewDoorDirection, nullptr, true);
 
 #if WITH_EDITORONLY_DATA
@@ -289,26 +731,234 @@ void ADoor::SetDoorStateReplicationEnabled(bool bEnabled, bool bReplicateNow)
 		bEnableDoorStateReplication = bEnabled;
 		if (bEnableDoorStateReplication && bReplicateNow)
 		{
-			MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, RepDoorState, this);
+			UpdateRepDoorState();
 			ForceNetUpdate();
 		}
 	}
 }
 
-float ADoor::GetLastAvatarReplicationExpirationTime_Implementation() const
+void ADoor::UpdateRepDoorState()
+{
+	if (!HasAuthority() || GetNetMode() == NM_Standalone)
+	{
+		return;
+	}
+
+	FDoorRepState RepState;
+	if (bEnableDoorStateReplication || !UDoorStatics::UnpackRepDoorState(RepDoorState, RepState))
+	{
+		RepState.DoorState = DoorState;
+		RepState.DoorDirection = DoorDirection;
+		RepState.PredictionId = AcceptedPredictionId;
+		RepState.PredictionOwner = AcceptedPredictionOwner;
+	}
+	RepState.DoorAccess = DoorAccess;
+	RepState.DoorOpenDirection = DoorOpenDirection;
+	RepState.DoorOpenMotion = DoorOpenMotion;
+
+	const uint32 NewRepDoorState = UDoorStatics::PackRepDoorState(RepState);
+	if (RepDoorState != NewRepDoorState)
+	{
+		RepDoorState = NewRepDoorState;
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, RepDoorState, this);
+		NotifyNetActivity();
+	}
+}
+
+bool ADoor::IsDoorNetActive() const
 {
-	return LastAvatarReplicationExpirationTime;
+	return IsDoorInMotion() || IsDoorOnCooldown() || GetWorldTimerManager().IsTimerActive(NetActiveLingerTimerHandle);
+}
+
+void ADoor::NotifyNetActivity()
+{
+	if (!bAdaptiveNetUpdateFrequency || !HasAuthority() || GetNetMode() == NM_Standalone)
+	{
+		return;
+	}
+
+	// Remain active for a while in case the door is interacted with again
+	if (ActiveNetLingerTime > 0.f)
+	{
+		GetWorldTimerManager().SetTimer(NetActiveLingerTimerHandle, this, &ThisClass::OnNetActiveLingerFinished,
+			ActiveNetLingerTime, false);
+	}
+
+	// The door was idle, don't make clients wait for the next idle update
+	if (!bNetActive)
+	{
+		UpdateNetUpdateRate();
+		ForceNetUpdate();
+	}
+}
+
+void ADoor::UpdateNetUpdateRate()
+{
+	if (!bAdaptiveNetUpdateFrequency || !HasAuthority() || GetNetMode() == NM_Standalone)
+	{
+		return;
+	}
+
+	const bool bActive = IsDoorNetActive();
+	if (bNetActive != bActive)
+	{
+		ApplyNetUpdateRate(bActive);
+	}
+}
+
+void ADoor::ApplyNetUpdateRate(bool bActive)
+{
+	bNetActive = bActive;
+
+	const float Frequency = bActive ? ActiveNetUpdateFrequency : IdleNetUpdateFrequency;
+	UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::UpdateNetUpdateRate: %s, NetUpdateFrequency: %.1f"), *GetRoleString(),
+		bActive ? TEXT("Active") : TEXT("Idle"), Frequency);
+	
+#if UE_5_05_OR_LATER
+	SetNetUpdateFrequency(Frequency);
+	SetMinNetUpdateFrequency(FMath::Min<float>(IdleNetUpdateFrequency, Frequency));
+#else
+	NetUpdateFrequency = Frequency;
+	MinNetUpdateFrequency = FMath::Min<float>(IdleNetUpdateFrequency, Frequency);
+#endif
+	NetPriority = bActive ? ActiveNetPriority : IdleNetPriority;
+}
+
+void ADoor::OnNetActiveLingerFinished()
+{
+	// Clear the timer -- its still considered active on this frame which would keep the door active
+	GetWorldTimerManager().ClearTimer(NetActiveLingerTimerHandle);
+
+	UpdateNetUpdateRate();
+}
+
+float ADoor::GetPredictionTimeout_Implementation() const
+{
+	return PredictionTimeout;
+}
+
+uint8 ADoor::GeneratePredictionId() const
+{
+	// 0 is reserved for interactions that are not predicted
+	LastPredictionId = LastPredictionId == MAX_uint8 ? 1 : LastPredictionId + 1;
+	return LastPredictionId;
+}
+
+void ADoor::SetActivationPrediction(uint8 PredictionId, const AActor* Avatar) const
+{
+	ActivationPredictionId = PredictionId;
+	ActivationPredictionOwner = GetPredictionOwner(Avatar);
+}
+
+uint16 ADoor::GetPredictionOwner(const AActor* Avatar)
+{
+	// PlayerIds are assigned by the server and replicated, so both sides agree on the owner
+	// Gameplay event instigators may be the controller or player state rather than the pawn
+	const APlayerState* PlayerState = Cast<APlayerState>(Avatar);
+	if (const APawn* Pawn = Cast<APawn>(Avatar))
+	{
+		PlayerState = Pawn->GetPlayerState();
+	}
+	else if (const AController* Controller = Cast<AController>(Avatar))
+	{
+		PlayerState = Controller->PlayerState;
+	}
+	if (!PlayerState)
+	{
+		return 0;
+	}
+	return static_cast<uint16>((static_cast<uint32>(PlayerState->GetPlayerId()) & 0xFFF) % 0xFFF + 1);
+}
+
+void ADoor::AddPendingPrediction(uint8 PredictionId, uint16 PredictionOwner, EDoorState NewDoorState,
+	EDoorDirection NewDoorDirection)
+{
+	// Nothing to reconcile with if the server isn't replicating the door state
+	const float Timeout = GetPredictionTimeout();
+	if (Timeout <= 0.f || !bEnableDoorStateReplication)
+	{
+		return;
+	}
+
+	// Discard the oldest prediction if we're predicting faster than the server can respond
+	if (PendingPredictions.Num() >= 4)
+	{
+		PendingPredictions.RemoveAt(0);
+	}
+	PendingPredictions.Emplace(PredictionId, PredictionOwner, NewDoorState, NewDoorDirection);
+
+	// Restart the timeout from the newest prediction
+	GetWorldTimerManager().SetTimer(PredictionTimeoutTimerHandle, this, &ThisClass::OnPredictionTimeout, Timeout, false);
+}
+
+void ADoor::OnPredictionTimeout()
+{
+	if (PendingPredictions.IsEmpty())
+	{
+		return;
+	}
+
+	UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::OnPredictionTimeout: %d predictions were not acknowledged"), *GetRoleString(),
+		PendingPredictions.Num());
+
+	// The server never acknowledged our prediction, its state is authoritative
+	PendingPredictions.Reset();
+	
+	FDoorRepState RepState;
+	if (UDoorStatics::UnpackRepDoorState(RepDoorState, RepState))
+	{
+		ReconcileRepDoorState(RepState);
+	}
 }
 
 void ADoor::GetRepDoorState(EDoorState& OutDoorState, EDoorDirection& OutDoorDirection) const
 {
-	UDoorStatics::UnpackDoorState(RepDoorState, OutDoorState, OutDoorDirection);
+	UDoorStatics::UnpackDoorState(GetRepDoorStatePackedBits(), OutDoorState, OutDoorDirection);
 }
 
-void ADoor::SetDoorState(EDoorState NewDoorState, EDoorDirection NewDoorDirection, AActor* Avatar, bool bClientSimulation)
+void ADoor::SetDoorState(EDoorState NewDoorState, EDoorDirection NewDoorDirection, AActor* Avatar, bool bClientSimulation,
+	uint8 PredictionId)
 {
+	// Don't start closing on a pawn in the doorway, replicated states are always applied
+	// Interactions are rejected earlier with Door.Fail.DoorwayOccupied, this catches auto doors and direct calls
+	if (NewDoorState == EDoorState::Closing && DoorState != EDoorState::Closing && !bClientSimulation && ShouldDoorwayBlockClosing())
+	{
+		UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::SetDoorState: Refusing to close while the doorway is occupied"), *GetRoleString());
+		return;
+	}
+
+	// Abilities that don't pass the PredictionId use the one they activated with
+	if (IsValid(Avatar) && !bClientSimulation)
+	{
+		if (PredictionId == 0 && ActivationPredictionOwner == GetPredictionOwner(Avatar))
+		{
+			PredictionId = ActivationPredictionId;
+		}
+		ActivationPredictionId = 0;
+		ActivationPredictionOwner = 0;
+	}
+	
 	if (DoorState != NewDoorState || DoorDirection != NewDoorDirection)
 	{
+		if (IsValid(Avatar) && !bClientSimulation)
+		{
+			if (HasAuthority())
+			{
+				// Echo the interaction back to the predicting client
+				AcceptedPredictionId = PredictionId;
+				AcceptedPredictionOwner = GetPredictionOwner(Avatar);
+			}
+			else
+			{
+				// Hold replication until the server acknowledges our prediction
+				AddPendingPrediction(PredictionId, GetPredictionOwner(Avatar), NewDoorState, NewDoorDirection);
+			}
+		}
+
+		// Changes nobody interacted with keep the accepted PredictionId, e.g. Opening -> Open may replicate before the
+		// client has seen the acknowledgement, and the client would otherwise wait out the PredictionTimeout
+		// Stale echoes can't acknowledge later predictions, which always have a newer PredictionId
+		
 		const EDoorState OldDoorState = DoorState;
 		const EDoorDirection OldDoorDirection = DoorDirection;
 		DoorState = NewDoorState;
@@ -329,26 +979,6 @@ void ADoor::OnDoorStateChanged(EDoorState OldDoorState, EDoorState NewDoorState,
 
 	// Update the last avatar
 	LastAvatar = Avatar;
-	if (HasAuthority() && IsValid(Avatar))
-	{
-		// We make the LastAvatar the owner for a short time so their replication doesn't fight the prediction
-		SetOwner(Avatar);
-
-		// Clear the LastAvatar after a short time
-		const float ReplicationExpirationTime = GetLastAvatarReplicationExpirationTime();
-		if (ReplicationExpirationTime > 0.f)
-		{
-			// Clear in-progress timer
-			GetWorldTimerManager().ClearTimer(LastAvatarReplicationTimerHandle);
-		
-			const FTimerDelegate TimerDelegate = FTimerDelegate::CreateWeakLambda(this, [this]
-			{
-				LastAvatar = nullptr;
-				SetOwner(nullptr);
-			});
-			GetWorldTimerManager().SetTimer(LastAvatarReplicationTimerHandle, TimerDelegate, ReplicationExpirationTime, false);
-		}
-	}
 
 	// Update door access
 	if (bHasPendingDoorAccess)
@@ -423,11 +1053,62 @@ void ADoor::OnDoorStateChanged(EDoorState OldDoorState, EDoorState NewDoorState,
 		OnDoorInMotionInterrupted(OldDoorState, NewDoorState, OldDoorDirection, NewDoorDirection, bClientSimulation);
 	}
 
-	// Replicate the door state to clients
-	if (HasAuthority() && GetNetMode() != NM_Standalone && bEnableDoorStateReplication)
+	// Replicate the door state to clients, along with any pending access changes we applied above
+	UpdateRepDoorState();
+
+	// Replicate more frequently while the door is in use
+	if (OldDoorState != NewDoorState || OldDoorDirection != NewDoorDirection)
 	{
-		RepDoorState = UDoorStatics::PackDoorState(DoorState, DoorDirection);
-		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, RepDoorState, this);
+		NotifyNetActivity();
+
+		// Allow spatial queries by door state
+		if (UDoorSpatialSubsystem* SpatialSubsystem = GetWorld()->GetSubsystem<UDoorSpatialSubsystem>())
+		{
+			SpatialSubsystem->UpdateDoor(this);
+		}
+
+		// Open or close our portal
+		if (UDoorPortalSubsystem* PortalSubsystem = GetWorld()->GetSubsystem<UDoorPortalSubsystem>())
+		{
+			PortalSubsystem->UpdateDoor(this);
+		}
+
+		// A new state replaces whatever the doorway was holding
+		bDoorwayHold = false;
+		
+		// Drive the leaf toward the new state
+		if (DoorAlphaMode == EAlphaMode::Physics)
+		{
+			UpdateDoorPhysicsTarget();
+		}
+
+		// Feed the state change to the deterministic simulation
+		if (DoorAlphaMode == EAlphaMode::Fixed)
+		{
+			FixedSim.ApplyInput(NewDoorState, NewDoorDirection);
+			if (IsDoorStateInMotion(NewDoorState) && IsDoorStateStationary(OldDoorState))
+			{
+				FixedSimAccumulator = 0.f;
+			}
+		}
+
+		// Send the new target to the physics step
+		if (bAsyncDoorMotionActive)
+		{
+			if (UDoorAsyncPhysicsSubsystem* AsyncPhysicsSubsystem = GetWorld()->GetSubsystem<UDoorAsyncPhysicsSubsystem>())
+			{
+				AsyncPhysicsSubsystem->UpdateDoor(this);
+			}
+		}
+
+		// Push pawns out of the way until we stop moving
+		if (bPushPawns && IsDoorStateInMotion(NewDoorState))
+		{
+			if (UDoorPushSubsystem* PushSubsystem = GetWorld()->GetSubsystem<UDoorPushSubsystem>())
+			{
+				PushSubsystem->RegisterDoor(this);
+			}
+		}
 	}
 
 	// Blueprint callback
@@ -445,6 +1126,12 @@ void ADoor::OnDoorStateChanged(EDoorState OldDoorState, EDoorState NewDoorState,
 		K2_OnDoorStateChangedCosmetic(OldDoorState, NewDoorState, OldDoorDirection, NewDoorDirection, Avatar, bClientSimulation);
 	}
 
+	// State and cooldown have changed
+	InvalidateDoorAffordance();
+
+	// Open doors are cheaper to path through
+	UpdateDoorNavLinks();
+
 #if WITH_EDITORONLY_DATA
 	if (GetNetMode() != NM_DedicatedServer && DoorCVars::bShowDoorStateDuringPIE)
 	{
@@ -710,41 +1397,151 @@ float ADoor::GetDoorInterpRateFromState(EDoorState State, EDoorDirection Directi
 	case EDoorDirection::Outward: return DoorCloseOutwardInterpRate;
 	case EDoorDirection::Inward: return DoorCloseInwardInterpRate;
 		}
-		break;
-	default: return 0.f;
+		break;
+	default: return 0.f;
+	}
+	return 0.f;
+}
+
+// -------------------------------------------------------------
+// Door Alpha
+
+bool ADoor::SetDoorAlpha(float NewDoorAlpha)
+{
+	const float PrevDoorAlpha = DoorAlpha;
+
+	// Clamp -1 to 1
+	NewDoorAlpha = FMath::Clamp<float>(NewDoorAlpha, -1.f, 1.f);
+
+	// Snap if nearly finished closing
+	if (IsDoorClosedOrClosing() && FMath::IsNearlyZero(NewDoorAlpha))
+	{
+		UE_LOG(LogDoors, VeryVerbose, TEXT("%s ADoor::SetDoorAlpha: Snap to 0"), *GetRoleString());
+		NewDoorAlpha = 0.f;
+	}
+
+	// Snap if nearly finished opening
+	if (IsDoorOpenOrOpening() && FMath::IsNearlyEqual(FMath::Abs<float>(NewDoorAlpha), 1.f))
+	{
+		UE_LOG(LogDoors, VeryVerbose, TEXT("%s ADoor::SetDoorAlpha: Snap to 1"), *GetRoleString());
+		NewDoorAlpha = FMath::Sign(NewDoorAlpha);
+	}
+
+	// Update the door alpha
+	DoorAlpha = NewDoorAlpha;
+
+	// Replicate the door alpha for externally driven doors
+	if (ShouldReplicateDoorAlpha() && HasAuthority() && GetNetMode() != NM_Standalone)
+	{
+		UpdateRepDoorAlpha();
+	}
+
+	OnDoorAlphaChanged(PrevDoorAlpha, NewDoorAlpha);
+	return true;
+}
+
+void ADoor::UpdateRepDoorAlpha(bool bForce)
+{
+	const uint8 Bits = static_cast<uint8>(FMath::Clamp<int32>(DoorAlphaReplicationBits, 4, 16));
+	const uint16 Quantized = UDoorStatics::QuantizeDoorAlpha(DoorAlpha, Bits);
+
+	// Nothing to send if the change isn't visible at this bit depth
+	if (Quantized == RepDoorAlpha.Value && Bits == RepDoorAlpha.Bits)
+	{
+		GetWorldTimerManager().ClearTimer(DoorAlphaSendTimerHandle);
+		return;
+	}
+
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+	const float Elapsed = LastDoorAlphaSendTime >= 0.f ? TimeSeconds - LastDoorAlphaSendTime : UE_BIG_NUMBER;
+	if (!bForce)
+	{
+		// Send faster the faster the door is moving
+		const float LastSentAlpha = UDoorStatics::DequantizeDoorAlpha(RepDoorAlpha.Value, RepDoorAlpha.Bits);
+		const float Speed = Elapsed > 0.f ? FMath::Abs(DoorAlpha - LastSentAlpha) / Elapsed : 0.f;
+		const float SendRate = FMath::GetMappedRangeValueClamped(FVector2f(0.f, DoorAlphaMaxSendRateSpeed),
+			FVector2f(DoorAlphaMinSendRate, FMath::Max<float>(DoorAlphaMinSendRate, DoorAlphaMaxSendRate)), Speed);
+		const float SendInterval = 1.f / FMath::Max<float>(SendRate, 1.f);
+		
+		// Too soon, send whatever the latest alpha is once the interval elapses
+		if (Elapsed < SendInterval)
+		{
+			if (!GetWorldTimerManager().IsTimerActive(DoorAlphaSendTimerHandle))
+			{
+				GetWorldTimerManager().SetTimer(DoorAlphaSendTimerHandle, this, &ThisClass::FlushRepDoorAlpha,
+					SendInterval - Elapsed, false);
+			}
+			return;
+		}
 	}
-	return 0.f;
-}
 
-// -------------------------------------------------------------
-// Door Alpha
+	GetWorldTimerManager().ClearTimer(DoorAlphaSendTimerHandle);
+	NotifyNetActivity();
+	LastDoorAlphaSendTime = TimeSeconds;
+	RepDoorAlpha.Value = Quantized;
+	RepDoorAlpha.Bits = Bits;
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, RepDoorAlpha, this);
+}
 
-bool ADoor::SetDoorAlpha(float NewDoorAlpha)
+void ADoor::OnRep_DoorAlpha()
 {
-	const float PrevDoorAlpha = DoorAlpha;
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+	const float NewDoorAlpha = UDoorStatics::DequantizeDoorAlpha(RepDoorAlpha.Value, RepDoorAlpha.Bits);
 
-	// Clamp -1 to 1
-	NewDoorAlpha = FMath::Clamp<float>(NewDoorAlpha, -1.f, 1.f);
+	// Start interpolating from where we currently are
+	if (DoorAlphaSamples.IsEmpty())
+	{
+		DoorAlphaSamples.Add({ TimeSeconds - DoorAlphaInterpolationDelay, DoorAlpha });
+	}
 
-	// Snap if nearly finished closing
-	if (IsDoorClosedOrClosing() && FMath::IsNearlyZero(NewDoorAlpha))
+	// Discard the oldest sample if we're receiving faster than we can interpolate
+	if (DoorAlphaSamples.Num() >= 8)
 	{
-		UE_LOG(LogDoors, VeryVerbose, TEXT("%s ADoor::SetDoorAlpha: Snap to 0"), *GetRoleString());
-		NewDoorAlpha = 0.f;
+		DoorAlphaSamples.RemoveAt(0);
 	}
+	DoorAlphaSamples.Add({ TimeSeconds, NewDoorAlpha });
 
-	// Snap if nearly finished opening
-	if (IsDoorOpenOrOpening() && FMath::IsNearlyEqual(FMath::Abs<float>(NewDoorAlpha), 1.f))
+	if (!IsActorTickEnabled())
 	{
-		UE_LOG(LogDoors, VeryVerbose, TEXT("%s ADoor::SetDoorAlpha: Snap to 1"), *GetRoleString());
-		NewDoorAlpha = FMath::Sign(NewDoorAlpha);
+		bTickEnabledForDoorAlpha = true;
+		SetActorTickEnabled(true);
 	}
+}
 
-	// Update the door alpha
-	DoorAlpha = NewDoorAlpha;
+void ADoor::TickRepDoorAlpha()
+{
+	if (DoorAlphaSamples.IsEmpty())
+	{
+		return;
+	}
 
-	OnDoorAlphaChanged(PrevDoorAlpha, NewDoorAlpha);
-	return true;
+	// Display the door alpha from slightly in the past so we always have a sample to interpolate towards
+	const float RenderTime = GetWorld()->GetTimeSeconds() - DoorAlphaInterpolationDelay;
+
+	// Discard samples we've already passed
+	while (DoorAlphaSamples.Num() >= 2 && DoorAlphaSamples[1].Time <= RenderTime)
+	{
+		DoorAlphaSamples.RemoveAt(0);
+	}
+
+	const FDoorAlphaSample& From = DoorAlphaSamples[0];
+	if (DoorAlphaSamples.Num() >= 2)
+	{
+		const FDoorAlphaSample& To = DoorAlphaSamples[1];
+		const float Range = To.Time - From.Time;
+		const float Alpha = Range > UE_KINDA_SMALL_NUMBER ? (RenderTime - From.Time) / Range : 1.f;
+		SetDoorAlpha(FMath::Lerp<float>(From.Alpha, To.Alpha, FMath::Clamp<float>(Alpha, 0.f, 1.f)));
+		return;
+	}
+
+	// Reached the last sample, wait for the next one
+	SetDoorAlpha(From.Alpha);
+	DoorAlphaSamples.Reset();
+	if (bTickEnabledForDoorAlpha)
+	{
+		bTickEnabledForDoorAlpha = false;
+		SetActorTickEnabled(false);
+	}
 }
 
 float ADoor::GetDoorAlphaFromDoorTime(float DoorTime, EDoorState State, EDoorDirection Direction) const
@@ -782,6 +1579,15 @@ void ADoor::OnDoorAlphaChanged(float OldDoorAlpha, float NewDoorAlpha)
 	
 	K2_OnDoorAlphaChanged(OldDoorAlpha, NewDoorAlpha, DoorState, DoorDirection, DoorTime, TransitionTime);
 
+	// GetDoorLocation() may follow the door mesh, which has likely moved
+	InvalidateDoorSidePlane();
+
+	// Our portal's openness follows the door alpha
+	if (UDoorPortalSubsystem* PortalSubsystem = GetWorld()->GetSubsystem<UDoorPortalSubsystem>())
+	{
+		PortalSubsystem->UpdateDoor(this);
+	}
+
 	// Trigger notifies due to change in alpha
 	HandleDoorAlphaNotifies(OldDoorAlpha, NewDoorAlpha);
 }
@@ -905,10 +1711,9 @@ void ADoor::OnDoorAccessChanged(EDoorAccess OldDoorAccess, EDoorAccess NewDoorAc
 	
 	bHasPendingDoorAccess = false;
 
-	if (HasAuthority() && GetNetMode() != NM_Standalone)
-	{
-		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, DoorAccess, this);
-	}
+	UpdateRepDoorState();
+	InvalidateDoorAffordance();
+	UpdateDoorNavLinks();
 
 	K2_OnDoorAccessChanged(OldDoorAccess, NewDoorAccess);
 }
@@ -960,10 +1765,9 @@ void ADoor::OnDoorOpenDirectionChanged(EDoorOpenDirection OldDoorOpenDirection,
 	
 	bHasPendingDoorAccess = false;
 
-	if (HasAuthority() && GetNetMode() != NM_Standalone)
-	{
-		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, DoorOpenDirection, this);
-	}
+	UpdateRepDoorState();
+	InvalidateDoorAffordance();
+	UpdateDoorNavLinks();
 	
 	K2_OnDoorOpenDirectionChanged(OldDoorOpenDirection, NewDoorOpenDirection);
 }
@@ -1013,10 +1817,8 @@ void ADoor::OnDoorOpenMotionChanged(EDoorMotion OldDoorOpenMotion, EDoorMotion N
 	UE_LOG(LogDoors, Verbose, TEXT("%s OnDoorOpenMotionChanged: OldDoorOpenMotion: %s, NewDoorOpenMotion: %s"), *GetRoleString(),
 		*UDoorStatics::DoorMotionToString(OldDoorOpenMotion), *UDoorStatics::DoorMotionToString(NewDoorOpenMotion));
 	
-	if (HasAuthority() && GetNetMode() != NM_Standalone)
-	{
-		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, DoorOpenMotion, this);
-	}
+	UpdateRepDoorState();
+	InvalidateDoorAffordance();
 	
 	K2_OnDoorOpenMotionChanged(OldDoorOpenMotion, NewDoorOpenMotion);
 }
@@ -1025,6 +1827,10 @@ void ADoor::OnStationaryCooldownFinished()
 {
 	// Clear the timer -- its still considered active on this frame which could cause other checks to fail
 	GetWorldTimerManager().ClearTimer(StationaryCooldownTimerHandle);
+
+	// The door may now be idle
+	UpdateNetUpdateRate();
+	InvalidateDoorAffordance();
 	
 	// Broadcast the delegate
 	if (OnDoorStationaryCooldownFinishedDelegate.IsBound())
@@ -1043,6 +1849,10 @@ void ADoor::OnInMotionCooldownFinished()
 {
 	// Clear the timer -- its still considered active on this frame which could cause other checks to fail
 	GetWorldTimerManager().ClearTimer(MotionCooldownTimerHandle);
+
+	// The door may now be idle
+	UpdateNetUpdateRate();
+	InvalidateDoorAffordance();
 	
 	// Broadcast the delegate
 	if (OnDoorInMotionCooldownFinishedDelegate.IsBound())
@@ -1102,16 +1912,89 @@ bool ADoor::IsDoorOnStationaryCooldown() const
 
 bool ADoor::ShouldAbilityRespondToDoorEvent(const AActor* Avatar, EDoorState ClientDoorState,
 	EDoorDirection ClientDoorDirection, EDoorSide ClientDoorSide, EDoorState& NewDoorState,
-	EDoorDirection& NewDoorDirection, EDoorMotion& DoorMotion, FGameplayTag& FailReason) const
+	EDoorDirection& NewDoorDirection, EDoorMotion& DoorMotion, FGameplayTag& FailReason, float ClientTimestamp) const
 {
 	// Output a fail reason for UI to respond to, e.g. a locked icon
 	FailReason = FGameplayTag::EmptyTag;
+
+	// Server-side arbitration, reject cheaply before evaluating any door logic
+	UDoorInteractionSubsystem* InteractionSubsystem = HasAuthority() ? GetWorld()->GetSubsystem<UDoorInteractionSubsystem>() : nullptr;
+	if (InteractionSubsystem && !InteractionSubsystem->HasClaimedDoor(this, Avatar))
+	{
+		// Another avatar already won this door on this frame
+		if (InteractionSubsystem->IsDoorContested(this, Avatar))
+		{
+			FailReason = FDoorTags::Door_Fail_Contested;
+			UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::ShouldAbilityRespondToDoorEvent: Door is contested"), *GetRoleString());
+			return false;
+		}
+
+		// Drop spam from remote avatars
+		if (GetNetMode() != NM_Standalone && !InteractionSubsystem->ConsumeInteractionToken(Avatar))
+		{
+			FailReason = FDoorTags::Door_Fail_RateLimited;
+			UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::ShouldAbilityRespondToDoorEvent: Avatar is rate limited"), *GetRoleString());
+			return false;
+		}
+	}
 	
+	if (!EvaluateDoorInteraction(Avatar, ClientDoorState, ClientDoorDirection, ClientDoorSide, ClientTimestamp,
+		NewDoorState, NewDoorDirection, DoorMotion, FailReason))
+	{
+		return false;
+	}
+
+	// This avatar wins the door for this frame
+	if (InteractionSubsystem)
+	{
+		InteractionSubsystem->ClaimDoor(this, Avatar);
+	}
+
+	return true;
+}
+
+bool ADoor::ShouldDoorRespondToServerAgent(const AActor* Avatar, EDoorSide DoorSide, EDoorState& NewDoorState,
+	EDoorDirection& NewDoorDirection, EDoorMotion& DoorMotion, FGameplayTag& FailReason) const
+{
+	FailReason = FGameplayTag::EmptyTag;
+
+	if (!HasAuthority())
+	{
+		return false;
+	}
+
+	// Players still win the door for this frame, but server agents don't spend the interaction tokens
+	UDoorInteractionSubsystem* InteractionSubsystem = GetWorld()->GetSubsystem<UDoorInteractionSubsystem>();
+	if (InteractionSubsystem && InteractionSubsystem->IsDoorContested(this, Avatar))
+	{
+		FailReason = FDoorTags::Door_Fail_Contested;
+		UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::ShouldDoorRespondToServerAgent: Door is contested"), *GetRoleString());
+		return false;
+	}
+
+	if (!EvaluateDoorInteraction(Avatar, DoorState, DoorDirection, DoorSide, -1.f, NewDoorState, NewDoorDirection,
+		DoorMotion, FailReason))
+	{
+		return false;
+	}
+
+	if (InteractionSubsystem)
+	{
+		InteractionSubsystem->ClaimDoor(this, Avatar);
+	}
+
+	return true;
+}
+
+bool ADoor::EvaluateDoorInteraction(const AActor* Avatar, EDoorState ClientDoorState, EDoorDirection ClientDoorDirection,
+	EDoorSide ClientDoorSide, float ClientTimestamp, EDoorState& NewDoorState, EDoorDirection& NewDoorDirection,
+	EDoorMotion& DoorMotion, FGameplayTag& FailReason) const
+{
 	// General optional override
 	if (!CanDoorChangeToAnyState(Avatar))
 	{
 		FailReason = FDoorTags::Door_Fail_CanDoorChangeToAnyState;
-		UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::ShouldAbilityRespondToDoorEvent: CanDoorChangeToAnyState failed"), *GetRoleString());
+		UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::EvaluateDoorInteraction: CanDoorChangeToAnyState failed"), *GetRoleString());
 		return false;
 	}
 	
@@ -1119,7 +2002,7 @@ bool ADoor::ShouldAbilityRespondToDoorEvent(const AActor* Avatar, EDoorState Cli
 	if (IsDoorOnCooldown())
 	{
 		FailReason = FDoorTags::Door_Fail_OnCooldown;
-		UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::ShouldAbilityRespondToDoorEvent: Door is on cooldown"), *GetRoleString());
+		UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::EvaluateDoorInteraction: Door is on cooldown"), *GetRoleString());
 		return false;
 	}
 
@@ -1127,18 +2010,17 @@ bool ADoor::ShouldAbilityRespondToDoorEvent(const AActor* Avatar, EDoorState Cli
 	if (IsDoorInMotion() && !CanInteractWhileInMotion())
 	{
 		FailReason = FDoorTags::Door_Fail_InMotion;
-		UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::ShouldAbilityRespondToDoorEvent: Door is in motion"), *GetRoleString());
+		UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::EvaluateDoorInteraction: Door is in motion"), *GetRoleString());
 		return false;
 	}
 
-	// Determine which side of the door the avatar is on
-	const EDoorSide CurrentDoorSide = UDoorStatics::GetDoorSide(Avatar, this);
-
 	// Check if we can use the client's door side
-	if (ClientDoorSide != CurrentDoorSide && !bTrustClientDoorSide)
+	// Rewind to when the client interacted if the current door side disagrees, the client sees the past
+	if (!bTrustClientDoorSide && ClientDoorSide != UDoorStatics::GetDoorSide(Avatar, this) &&
+		(ClientTimestamp < 0.f || ClientDoorSide != GetDoorSideAtTime(Avatar, ClientTimestamp)))
 	{
 		FailReason = FDoorTags::Door_Fail_ClientDoorSide;
-		UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::ShouldAbilityRespondToDoorEvent: Client door side is not trusted and does not match"), *GetRoleString());
+		UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::EvaluateDoorInteraction: Client door side is not trusted and does not match"), *GetRoleString());
 		return false;
 	}
 
@@ -1149,22 +2031,307 @@ bool ADoor::ShouldAbilityRespondToDoorEvent(const AActor* Avatar, EDoorState Cli
 		return false;
 	}
 
+	// Check if a pawn is standing in the doorway we want to close, SetDoorState() would refuse to close
+	if (NewDoorState == EDoorState::Closing && ShouldDoorwayBlockClosing())
+	{
+		FailReason = FDoorTags::Door_Fail_DoorwayOccupied;
+		UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::EvaluateDoorInteraction: Doorway is occupied"), *GetRoleString());
+		return false;
+	}
+
 	// General optional override
 	if (!CanChangeDoorState(Avatar, DoorState, NewDoorState, DoorDirection, NewDoorDirection))
 	{
 		FailReason = FDoorTags::Door_Fail_CanChangeDoorState;
-		UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::ShouldAbilityRespondToDoorEvent: CanChangeDoorState failed"), *GetRoleString());
+		UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::EvaluateDoorInteraction: CanChangeDoorState failed"), *GetRoleString());
 		return false;
 	}
 
 	return true;
 }
 
+bool ADoor::PreValidateDoorInteraction(const AActor* Avatar, FGameplayTag& FailReason, bool& bRejectionCertain) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ADoor::PreValidateDoorInteraction);
+	
+	FailReason = FGameplayTag::EmptyTag;
+	bRejectionCertain = false;
+
+	// Evaluate exactly what we would send to the server
+	EDoorState NewDoorState;
+	EDoorDirection NewDoorDirection;
+	EDoorMotion DoorMotion;
+	if (EvaluateDoorInteraction(Avatar, DoorState, DoorDirection, GetDoorSide(Avatar), -1.f,
+		NewDoorState, NewDoorDirection, DoorMotion, FailReason))
+	{
+		return true;
+	}
+
+	// Our cooldown and motion started when the state replicated to us, half a round trip after the server's
+	// By the time our interaction reaches the server, the server is a full round trip further along than us
+	float RoundTripTime = 0.f;
+	if (GetNetMode() == NM_Client)
+	{
+		const APawn* Pawn = Cast<APawn>(Avatar);
+		const APlayerState* PlayerState = Pawn ? Pawn->GetPlayerState() : nullptr;
+		RoundTripTime = PlayerState ? PlayerState->GetPingInMilliseconds() * 0.001f : 0.f;
+	}
+
+	if (FailReason == FDoorTags::Door_Fail_OnCooldown)
+	{
+		bRejectionCertain = GetRemainingCooldown() > RoundTripTime;
+	}
+	else if (FailReason == FDoorTags::Door_Fail_InMotion)
+	{
+		bRejectionCertain = GetRemainingDoorMotionTime() > RoundTripTime;
+	}
+	else
+	{
+		// Overrides may depend on data the client doesn't have, and pawns may leave the doorway before we reach the server
+		bRejectionCertain = FailReason != FDoorTags::Door_Fail_CanDoorChangeToAnyState &&
+			FailReason != FDoorTags::Door_Fail_CanChangeDoorState && FailReason != FDoorTags::Door_Fail_DoorwayOccupied;
+	}
+
+	UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::PreValidateDoorInteraction: %s %s"), *GetRoleString(),
+		*FailReason.ToString(), bRejectionCertain ? TEXT("(certain)") : TEXT("(uncertain)"));
+	
+	return false;
+}
+
+void ADoor::SetDoorwayHold(bool bHold)
+{
+	if (bDoorwayHold == bHold)
+	{
+		return;
+	}
+	bDoorwayHold = bHold;
+
+	UE_LOG(LogDoors, Verbose, TEXT("%s ADoor::SetDoorwayHold: %s"), *GetRoleString(),
+		bHold ? TEXT("Holding for occupied doorway") : TEXT("Doorway cleared"));
+
+	// The motor keeps driving the leaf toward the old target unless we retarget it
+	if (DoorAlphaMode == EAlphaMode::Physics)
+	{
+		UpdateDoorPhysicsTarget(true);
+	}
+
+	// The physics step keeps moving the leaf unless we send it a target to hold at
+	if (bAsyncDoorMotionActive)
+	{
+		if (UDoorAsyncPhysicsSubsystem* AsyncPhysicsSubsystem = GetWorld()->GetSubsystem<UDoorAsyncPhysicsSubsystem>())
+		{
+			AsyncPhysicsSubsystem->UpdateDoor(this);
+		}
+	}
+}
+
+float ADoor::GetDoorAlphaRate() const
+{
+	switch (DoorAlphaMode)
+	{
+	case EAlphaMode::Time: return 1.f / FMath::Max<float>(GetDoorTransitionTime(), 0.001f);
+	case EAlphaMode::InterpConstant: return GetDoorInterpRate();
+	default: return 0.f;
+	}
+}
+
+float ADoor::GetRemainingDoorMotionTime() const
+{
+	if (!IsDoorInMotion())
+	{
+		return 0.f;
+	}
+
+	const float RemainingAlpha = FMath::Abs(GetTargetDoorAlpha() - DoorAlpha);
+	switch (DoorAlphaMode)
+	{
+	case EAlphaMode::Time: return RemainingAlpha * GetDoorTransitionTime();
+	case EAlphaMode::Fixed:
+		{
+			// The alpha is eased, so count the simulation's remaining ticks, less the time already accumulated toward the next
+			const float TickInterval = 1.f / FDoorFixedSim::GetTicksPerSecond();
+			return FMath::Max<float>(0.f, FixedSim.GetRemainingTicks() * TickInterval - FixedSimAccumulator);
+		}
+	case EAlphaMode::InterpConstant:
+		{
+			const float InterpRate = GetDoorInterpRate();
+			return InterpRate > 0.f ? RemainingAlpha / InterpRate : 0.f;
+		}
+	default: return 0.f;
+	}
+}
+
+FDoorAffordance ADoor::GetDoorAffordance(EDoorSide Side) const
+{
+	FDoorAffordance Affordance = GetCachedDoorAffordance(Side);
+
+	// Doorway occupancy changes every frame without invalidating the cache, the interaction would be refused
+	if (Affordance.bCanInteract && Affordance.NewDoorState == EDoorState::Closing && ShouldDoorwayBlockClosing())
+	{
+		Affordance.bCanInteract = false;
+		Affordance.FailReason = FDoorTags::Door_Fail_DoorwayOccupied;
+	}
+	return Affordance;
+}
+
+const FDoorAffordance& ADoor::GetCachedDoorAffordance(EDoorSide Side) const
+{
+	const uint8 SideIndex = static_cast<uint8>(Side) & 0x1;
+	FDoorAffordance& Affordance = CachedAffordances[SideIndex];
+	if (CachedAffordanceMask & (1 << SideIndex))
+	{
+		return Affordance;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ADoor::GetDoorAffordance);
+
+	CachedAffordanceMask |= (1 << SideIndex);
+	Affordance = FDoorAffordance();
+
+	if (IsDoorOnCooldown())
+	{
+		Affordance.FailReason = FDoorTags::Door_Fail_OnCooldown;
+		return Affordance;
+	}
+
+	if (IsDoorInMotion() && !CanInteractWhileInMotion())
+	{
+		Affordance.FailReason = FDoorTags::Door_Fail_InMotion;
+		return Affordance;
+	}
+
+	Affordance.bCanInteract = UDoorStatics::ProgressDoorState(this, DoorState, DoorDirection, Side,
+		Affordance.NewDoorState, Affordance.NewDoorDirection, Affordance.Motion, Affordance.FailReason);
+	
+	return Affordance;
+}
+
+void ADoor::InvalidateDoorAffordance()
+{
+	CachedAffordanceMask = 0;
+
+	if (OnDoorAffordanceInvalidatedDelegate.IsBound())
+	{
+		OnDoorAffordanceInvalidatedDelegate.Broadcast(this);
+	}
+}
+
+const FDoorSidePlane& ADoor::GetDoorSidePlane() const
+{
+	// Transform updates are only bound from BeginPlay
+	if (bDoorSidePlaneDirty || !HasActorBegunPlay())
+	{
+		const FTransform DoorTransform = GetDoorTransform();
+		CachedDoorSidePlane.Location = DoorTransform.GetLocation();
+		CachedDoorSidePlane.Forward = DoorTransform.GetScaledAxis(EAxis::X);
+		bDoorSidePlaneDirty = !HasActorBegunPlay();
+	}
+	return CachedDoorSidePlane;
+}
+
+void ADoor::SetAutoDoorEnabled(bool bEnabled)
+{
+	bAutoDoor = bEnabled;
+
+	if (!HasActorBegunPlay())
+	{
+		return;
+	}
+	
+	if (UDoorProximitySubsystem* ProximitySubsystem = GetWorld()->GetSubsystem<UDoorProximitySubsystem>())
+	{
+		if (ShouldRunAutoDoor())
+		{
+			ProximitySubsystem->RegisterDoor(this);
+		}
+		else
+		{
+			ProximitySubsystem->UnregisterDoor(this);
+		}
+	}
+}
+
+bool ADoor::IsDoorwayOccupied() const
+{
+	UDoorOccupancySubsystem* OccupancySubsystem = GetWorld() ? GetWorld()->GetSubsystem<UDoorOccupancySubsystem>() : nullptr;
+	return OccupancySubsystem && OccupancySubsystem->IsDoorwayOccupied(this);
+}
+
+void ADoor::GetDoorwayOccupants(TArray<APawn*>& OutPawns) const
+{
+	OutPawns.Reset();
+	if (UDoorOccupancySubsystem* OccupancySubsystem = GetWorld() ? GetWorld()->GetSubsystem<UDoorOccupancySubsystem>() : nullptr)
+	{
+		OccupancySubsystem->GetDoorwayOccupants(this, OutPawns);
+	}
+}
+
+void ADoor::ReconcileAutoDoorPrediction()
+{
+	// Without replication the replicated state is stale, it would undo the door we opened
+	FDoorRepState RepState;
+	if (!HasAuthority() && bEnableDoorStateReplication && UDoorStatics::UnpackRepDoorState(RepDoorState, RepState))
+	{
+		ReconcileRepDoorState(RepState);
+	}
+}
+
+bool ADoor::CanAgentPassDoor(EDoorSide FromSide) const
+{
+	if (IsDoorOpenOrOpening())
+	{
+		return true;
+	}
+
+	if (DoorOpenDirection == EDoorOpenDirection::Locked)
+	{
+		return false;
+	}
+
+	switch (DoorAccess)
+	{
+	case EDoorAccess::Bidirectional: return true;
+	case EDoorAccess::Front: return FromSide == EDoorSide::Front;
+	case EDoorAccess::Behind: return FromSide == EDoorSide::Back;
+	default: return false;
+	}
+}
+
+void ADoor::UpdateDoorNavLinks()
+{
+	// Only the server navigates
+	if (!HasAuthority())
+	{
+		return;
+	}
+	
+	if (NavLinkFront)
+	{
+		NavLinkFront->UpdateFromDoor(this);
+	}
+	if (NavLinkBack)
+	{
+		NavLinkBack->UpdateFromDoor(this);
+	}
+}
+
 EDoorSide ADoor::GetDoorSide(const AActor* Avatar) const
 {
 	return UDoorStatics::GetDoorSide(Avatar, this);
 }
 
+EDoorSide ADoor::GetDoorSideAtTime(const AActor* Avatar, float Timestamp) const
+{
+	if (HasAuthority())
+	{
+		if (const UDoorRewindSubsystem* RewindSubsystem = GetWorld()->GetSubsystem<UDoorRewindSubsystem>())
+		{
+			return RewindSubsystem->GetDoorSideAtTime(Avatar, this, Timestamp);
+		}
+	}
+	return GetDoorSide(Avatar);
+}
+
 FString ADoor::GetRoleString() const
 {
 	return UDoorStatics::GetRoleString(this);
@@ -1175,7 +2342,13 @@ FString ADoor::GetRoleString() const
 void ADoor::HandleDoorPropertyChange()
 {
 	// Make sure we initialize the replicated property based on the default state
-	RepDoorState = UDoorStatics::PackDoorState(DoorState, DoorDirection);
+	FDoorRepState RepState;
+	RepState.DoorState = DoorState;
+	RepState.DoorDirection = DoorDirection;
+	RepState.DoorAccess = DoorAccess;
+	RepState.DoorOpenDirection = DoorOpenDirection;
+	RepState.DoorOpenMotion = DoorOpenMotion;
+	RepDoorState = UDoorStatics::PackRepDoorState(RepState);
 }
 
 void ADoor::PostLoad()
@@ -1191,9 +2364,12 @@ void ADoor::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChanged
 
 	const FName& PropertyName = PropertyChangedEvent.GetMemberPropertyName();
 
-	// Door state or direction
+	// Any property packed into the replicated door state
 	if (PropertyName.IsEqual(GET_MEMBER_NAME_CHECKED(ThisClass, DoorState)) ||
-		PropertyName.IsEqual(GET_MEMBER_NAME_CHECKED(ThisClass, DoorDirection)))
+		PropertyName.IsEqual(GET_MEMBER_NAME_CHECKED(ThisClass, DoorDirection)) ||
+		PropertyName.IsEqual(GET_MEMBER_NAME_CHECKED(ThisClass, DoorAccess)) ||
+		PropertyName.IsEqual(GET_MEMBER_NAME_CHECKED(ThisClass, DoorOpenDirection)) ||
+		PropertyName.IsEqual(GET_MEMBER_NAME_CHECKED(ThisClass, DoorOpenMotion)))
 	{
 		HandleDoorPropertyChange();
 	}
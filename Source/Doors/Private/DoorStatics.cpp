@@ -22,6 +22,33 @@ void UDoorStatics::UnpackDoorState(uint8 Packed, EDoorState& OutState, EDoorDire
 	OutDirection = static_cast<EDoorDirection>((Packed >> 2) & 0x1);
 }
 
+uint32 UDoorStatics::PackRepDoorState(const FDoorRepState& RepState)
+{
+	return static_cast<uint32>(PackDoorState(RepState.DoorState, RepState.DoorDirection))
+		 | ((static_cast<uint32>(RepState.DoorAccess) & 0x3) << 3)
+		 | ((static_cast<uint32>(RepState.DoorOpenDirection) & 0x3) << 5)
+		 | ((static_cast<uint32>(RepState.DoorOpenMotion) & 0x1) << 7)
+		 | (static_cast<uint32>(RepState.PredictionId) << 8)
+		 | ((static_cast<uint32>(RepState.PredictionOwner) & 0xFFF) << 16)
+		 | ((static_cast<uint32>(DoorRepStateVersion) & 0xF) << 28);
+}
+
+bool UDoorStatics::UnpackRepDoorState(uint32 RepDoorStatePacked, FDoorRepState& OutRepState)
+{
+	if (((RepDoorStatePacked >> 28) & 0xF) != DoorRepStateVersion)
+	{
+		return false;
+	}
+	
+	UnpackDoorState(static_cast<uint8>(RepDoorStatePacked & 0x7), OutRepState.DoorState, OutRepState.DoorDirection);
+	OutRepState.DoorAccess = static_cast<EDoorAccess>((RepDoorStatePacked >> 3) & 0x3);
+	OutRepState.DoorOpenDirection = static_cast<EDoorOpenDirection>((RepDoorStatePacked >> 5) & 0x3);
+	OutRepState.DoorOpenMotion = static_cast<EDoorMotion>((RepDoorStatePacked >> 7) & 0x1);
+	OutRepState.PredictionId = static_cast<uint8>((RepDoorStatePacked >> 8) & 0xFF);
+	OutRepState.PredictionOwner = static_cast<uint16>((RepDoorStatePacked >> 16) & 0xFFF);
+	return true;
+}
+
 uint8 UDoorStatics::PackTargetDataDoorState(EDoorState DoorState, EDoorDirection DoorDirection, EDoorSide DoorSide)
 {
 	return (static_cast<uint8>(DoorState) & 0x3)
@@ -36,161 +63,236 @@ void UDoorStatics::UnpackTargetDataDoorState(uint8 DoorStatePacked, EDoorState&
 	OutDoorSide = static_cast<EDoorSide>((DoorStatePacked >> 3) & 0x1);
 }
 
+uint16 UDoorStatics::QuantizeDoorAlpha(float DoorAlpha, uint8 Bits)
+{
+	const int32 MaxValue = (1 << (FMath::Clamp<int32>(Bits, 2, 16) - 1)) - 1;
+	const int32 Quantized = FMath::RoundToInt(FMath::Clamp<float>(DoorAlpha, -1.f, 1.f) * MaxValue);
+	return static_cast<uint16>(Quantized + MaxValue);
+}
+
+float UDoorStatics::DequantizeDoorAlpha(uint16 QuantizedAlpha, uint8 Bits)
+{
+	const int32 MaxValue = (1 << (FMath::Clamp<int32>(Bits, 2, 16) - 1)) - 1;
+	return FMath::Clamp<float>(static_cast<float>(static_cast<int32>(QuantizedAlpha) - MaxValue) / MaxValue, -1.f, 1.f);
+}
+
 void UDoorStatics::GetDoorFromAbilityActivationTargetData(
 	const FGameplayEventData& EventData, EDoorValid& Validate, EDoorState& DoorState, EDoorDirection& DoorDirection,
-	EDoorSide& DoorSide)
+	EDoorSide& DoorSide, float& ClientTimestamp, uint8& PredictionId)
 {
 	Validate = EDoorValid::NotValid;
+	ClientTimestamp = -1.f;
+	PredictionId = 0;
+
+	// Grasp only ever sends a single door target data
+	const UScriptStruct* DoorStruct = FDoorAbilityTargetData::StaticStruct();
 	for (const TSharedPtr<FGameplayAbilityTargetData>& Data : EventData.TargetData.Data)
 	{
-		if (Data.IsValid())
+		if (Data.IsValid() && Data->GetScriptStruct() == DoorStruct)
 		{
-			if (Data->GetScriptStruct() == FDoorAbilityTargetData::StaticStruct())
+			Validate = EDoorValid::Valid;
+			const FDoorAbilityTargetData* DoorData = static_cast<FDoorAbilityTargetData*>(Data.Get());
+			UnpackTargetDataDoorState(DoorData->PackedState, DoorState, DoorDirection, DoorSide);
+			ClientTimestamp = DoorData->ClientTimestamp;
+			PredictionId = DoorData->PredictionId;
+
+			// Let SetDoorState() pick up the PredictionId if the ability doesn't pass it through
+			const UActorComponent* Component = Cast<UActorComponent>(EventData.OptionalObject);
+			const ADoor* Door = Component ? Cast<ADoor>(Component->GetOwner()) : Cast<ADoor>(EventData.Target);
+			if (Door && PredictionId != 0)
 			{
-				Validate = EDoorValid::Valid;
-				const FDoorAbilityTargetData* DoorData = static_cast<FDoorAbilityTargetData*>(Data.Get());
-				UnpackTargetDataDoorState(DoorData->PackedState, DoorState, DoorDirection, DoorSide);
+				Door->SetActivationPrediction(PredictionId, EventData.Instigator);
 			}
+			return;
 		}
 	}
 }
 
-bool UDoorStatics::ProgressDoorState(const ADoor* Door, EDoorState DoorState, EDoorDirection DoorDirection,
-	EDoorSide DoorSide, EDoorState& NewDoorState, EDoorDirection& NewDoorDirection, EDoorMotion& Motion, FGameplayTag& FailReason)
+namespace DoorTransition
 {
-	NewDoorState = Door->GetDoorState();
-	NewDoorDirection = Door->GetDoorDirection();
-
-	// Door is not valid
-	if (!IsValid(Door))
+	/**
+	 * Every input to ProgressDoorState is a tiny enum, so every possible transition is resolved at compile time
+	 * Index bits 0-1: Client State, 2-3: Door State, 4: Door Direction, 5-6: Access, 7-8: Open Direction, 9: Side, 10: Open Motion
+	 * Entry bits 0-1: New State, 2: New Direction, 3: Motion, 4-6: EFail
+	 */
+	static constexpr int32 NumEntries = 1 << 11;
+
+	enum EFail : uint8
 	{
-		FailReason = FDoorTags::Door_Fail_DoorNotValid;
-		UE_LOG(LogDoors, Verbose, TEXT("UDoorStatics::ProgressDoorState: Door is not valid"));
-		return false;
+		None,
+		Locked,
+		AlreadyClosed,
+		AlreadyOpen,
+		NoAccessFromFront,
+		NoAccessFromBack,
+	};
+
+	static constexpr uint16 PackIndex(EDoorState ClientState, EDoorState DoorState, EDoorDirection DoorDirection,
+		EDoorAccess Access, EDoorOpenDirection OpenDirection, EDoorSide Side, EDoorMotion OpenMotion)
+	{
+		return static_cast<uint16>(
+			(static_cast<uint16>(ClientState) & 0x3)
+			| ((static_cast<uint16>(DoorState) & 0x3) << 2)
+			| ((static_cast<uint16>(DoorDirection) & 0x1) << 4)
+			| ((static_cast<uint16>(Access) & 0x3) << 5)
+			| ((static_cast<uint16>(OpenDirection) & 0x3) << 7)
+			| ((static_cast<uint16>(Side) & 0x1) << 9)
+			| ((static_cast<uint16>(OpenMotion) & 0x1) << 10));
 	}
-	
-	// Door is locked
-	if (Door->GetDoorOpenDirection() == EDoorOpenDirection::Locked)
+
+	static constexpr uint8 PackEntry(EDoorState NewState, EDoorDirection NewDirection, EDoorMotion Motion, EFail Fail)
 	{
-		FailReason = FDoorTags::Door_Fail_Locked;
-		UE_LOG(LogDoors, Verbose, TEXT("%s UDoorStatics::ProgressDoorState: Door is locked"), *GetRoleString(Door));
-		return false;
+		return static_cast<uint8>(
+			(static_cast<uint8>(NewState) & 0x3)
+			| ((static_cast<uint8>(NewDirection) & 0x1) << 2)
+			| ((static_cast<uint8>(Motion) & 0x1) << 3)
+			| ((static_cast<uint8>(Fail) & 0x7) << 4));
 	}
 
-	// Determine our desired interaction
-	const EDoorInteraction Interaction = GetDoorInteractionFromState(DoorState);
-	
-	// Are we already in the desired state?
-	switch (Interaction)
+	/** The transition logic, only evaluated at compile time to build the table */
+	static constexpr uint8 Resolve(uint16 Index)
 	{
-	case EDoorInteraction::Close:
-		if (Door->IsDoorClosedOrClosing())
+		const EDoorState ClientState = static_cast<EDoorState>(Index & 0x3);
+		const EDoorState DoorState = static_cast<EDoorState>((Index >> 2) & 0x3);
+		const EDoorDirection DoorDirection = static_cast<EDoorDirection>((Index >> 4) & 0x1);
+		const EDoorAccess Access = static_cast<EDoorAccess>((Index >> 5) & 0x3);
+		const EDoorOpenDirection OpenDirection = static_cast<EDoorOpenDirection>((Index >> 7) & 0x3);
+		const EDoorSide Side = static_cast<EDoorSide>((Index >> 9) & 0x1);
+		const EDoorMotion OpenMotion = static_cast<EDoorMotion>((Index >> 10) & 0x1);
+
+		// Door is locked
+		if (OpenDirection == EDoorOpenDirection::Locked)
 		{
-			FailReason = FDoorTags::Door_Fail_AlreadyClosed;
-			UE_LOG(LogDoors, Verbose, TEXT("%s UDoorStatics::ProgressDoorState: Door is already closed"), *GetRoleString(Door));
-			return false;
+			return PackEntry(DoorState, DoorDirection, EDoorMotion::Push, Locked);
 		}
-		break;
-	case EDoorInteraction::Open:
-		if (Door->IsDoorOpenOrOpening())
+
+		// Are we already in the desired state?
+		const bool bOpen = ClientState == EDoorState::Closed || ClientState == EDoorState::Closing;
+		if (!bOpen && (DoorState == EDoorState::Closed || DoorState == EDoorState::Closing))
 		{
-			FailReason = FDoorTags::Door_Fail_AlreadyOpen;
-			UE_LOG(LogDoors, Verbose, TEXT("%s UDoorStatics::ProgressDoorState: Door is already open"), *GetRoleString(Door));
-			return false;
+			return PackEntry(DoorState, DoorDirection, EDoorMotion::Push, AlreadyClosed);
 		}
-		break;
-	}
-
-	// Do we have the required access to open the door?
-	if (Interaction == EDoorInteraction::Open)
-	{
-		switch (Door->GetDoorAccess())
+		if (bOpen && (DoorState == EDoorState::Open || DoorState == EDoorState::Opening))
 		{
-		case EDoorAccess::Bidirectional:
-			// We can interact from either side
-			break;
-		case EDoorAccess::Behind:
-			// We can only interact from the back -- are we behind the door?
-			if (DoorSide != EDoorSide::Back)
-			{
-				FailReason = FDoorTags::Door_Fail_NoAccessFromFront;
-				UE_LOG(LogDoors, Verbose, TEXT("%s UDoorStatics::ProgressDoorState: Door access is behind, but we're in front"), *GetRoleString(Door));
-				return false;
-			}
-			break;
-		case EDoorAccess::Front:
-			// We can only interact from the front -- are we in front of the door?
-			if (DoorSide != EDoorSide::Front)
-			{
-				FailReason = FDoorTags::Door_Fail_NoAccessFromBack;
-				UE_LOG(LogDoors, Verbose, TEXT("%s UDoorStatics::ProgressDoorState: Door access is front, but we're behind"), *GetRoleString(Door));
-				return false;
-			}
-			break;
+			return PackEntry(DoorState, DoorDirection, EDoorMotion::Push, AlreadyOpen);
 		}
-	}
 
-	// Determine next door state
-	// Determine what motion we use to interact with the door, do we push or pull it
-	switch (Interaction)
-	{
-	case EDoorInteraction::Close:
-		// We are closing the door
-		NewDoorState = EDoorState::Closing;
-		
+		// We are closing the door, based on the direction it was open in
 		// We will push the door if we're in front of it, and pull it if we're behind it
-		Motion = DoorSide == EDoorSide::Front ? EDoorMotion::Push : EDoorMotion::Pull;
-		
-		// If the door is open, and we're closing the door, we close it based on the direction it was open in
-		// So we don't do anything here
-		// ---NewDoorDirection = NewDoorDirection;
-
-		UE_LOG(LogDoors, Verbose, TEXT("%s UDoorStatics::ProgressDoorState: Closing door %s from %s with %s"), *GetRoleString(Door),
-			*DoorDirectionToString(NewDoorDirection), *DoorSideToString(DoorSide), *DoorMotionToString(Motion));
-		
-		break;
-	case EDoorInteraction::Open:
-		// We are opening the door
-		NewDoorState = EDoorState::Opening;
+		if (!bOpen)
+		{
+			return PackEntry(EDoorState::Closing, DoorDirection,
+				Side == EDoorSide::Front ? EDoorMotion::Push : EDoorMotion::Pull, None);
+		}
 
-		// Let's try to open it the way we'd prefer
-		Motion = Door->GetDoorOpenMotion();
+		// Do we have the required access to open the door?
+		if (Access == EDoorAccess::Behind && Side != EDoorSide::Back)
+		{
+			return PackEntry(DoorState, DoorDirection, EDoorMotion::Push, NoAccessFromFront);
+		}
+		if (Access == EDoorAccess::Front && Side != EDoorSide::Front)
+		{
+			return PackEntry(DoorState, DoorDirection, EDoorMotion::Push, NoAccessFromBack);
+		}
 
-		// But what if we can't push or can't pull?
-		switch (Door->GetDoorOpenDirection())
+		// Let's try to open it the way we'd prefer, but what if we can't push or can't pull?
+		EDoorMotion Motion = OpenMotion;
+		if (OpenDirection == EDoorOpenDirection::Outward)
 		{
-		case EDoorOpenDirection::Bidirectional:
-			break;  // Nothing needs to change
-		case EDoorOpenDirection::Outward:
 			// Door only opens outward, if we're in front of the door, we can only pull, and if behind, only push
-			Motion = DoorSide == EDoorSide::Front ? EDoorMotion::Pull : EDoorMotion::Push;
-			break;
-		case EDoorOpenDirection::Inward:
+			Motion = Side == EDoorSide::Front ? EDoorMotion::Pull : EDoorMotion::Push;
+		}
+		else if (OpenDirection == EDoorOpenDirection::Inward)
+		{
 			// Door only opens inward, if we're in front of the door, we can only push, and if behind, only pull
-			Motion = DoorSide == EDoorSide::Front ? EDoorMotion::Push : EDoorMotion::Pull;
-			break;
-		case EDoorOpenDirection::Locked:
-			ensure(false);  // Handled
-			break;
+			Motion = Side == EDoorSide::Front ? EDoorMotion::Push : EDoorMotion::Pull;
 		}
 
 		// If standing in front of the door, and we're pushing, we want to push it inward
 		// If standing behind the door, and we're pulling, we want to pull it inward
-		if (DoorSide == EDoorSide::Front)
-		{
-			NewDoorDirection = Motion == EDoorMotion::Push ? EDoorDirection::Inward : EDoorDirection::Outward;
-		}
-		else
+		const EDoorMotion InwardMotion = Side == EDoorSide::Front ? EDoorMotion::Push : EDoorMotion::Pull;
+		const EDoorDirection NewDirection = Motion == InwardMotion ? EDoorDirection::Inward : EDoorDirection::Outward;
+		
+		return PackEntry(EDoorState::Opening, NewDirection, Motion, None);
+	}
+
+	struct FTable
+	{
+		uint8 Entries[NumEntries];
+
+		constexpr FTable()
+			: Entries()
 		{
-			NewDoorDirection = Motion == EDoorMotion::Pull ? EDoorDirection::Inward : EDoorDirection::Outward;
+			for (int32 i = 0; i < NumEntries; i++)
+			{
+				Entries[i] = Resolve(static_cast<uint16>(i));
+			}
 		}
+	};
+
+	static constexpr FTable Table;
+
+	// Spot checks
+	static_assert(Table.Entries[PackIndex(EDoorState::Closed, EDoorState::Closed, EDoorDirection::Outward, EDoorAccess::Bidirectional,
+		EDoorOpenDirection::Bidirectional, EDoorSide::Front, EDoorMotion::Push)]
+		== PackEntry(EDoorState::Opening, EDoorDirection::Inward, EDoorMotion::Push, None), "Push open from the front opens inward");
+	static_assert(Table.Entries[PackIndex(EDoorState::Open, EDoorState::Open, EDoorDirection::Inward, EDoorAccess::Front,
+		EDoorOpenDirection::Outward, EDoorSide::Back, EDoorMotion::Push)]
+		== PackEntry(EDoorState::Closing, EDoorDirection::Inward, EDoorMotion::Pull, None), "Close from behind pulls, ignoring access");
+	static_assert(Table.Entries[PackIndex(EDoorState::Closed, EDoorState::Closed, EDoorDirection::Outward, EDoorAccess::Behind,
+		EDoorOpenDirection::Bidirectional, EDoorSide::Front, EDoorMotion::Pull)]
+		== PackEntry(EDoorState::Closed, EDoorDirection::Outward, EDoorMotion::Push, NoAccessFromFront), "Access from behind only");
+}
 
-		UE_LOG(LogDoors, Verbose, TEXT("%s UDoorStatics::ProgressDoorState: Opening door %s from %s with %s"), *GetRoleString(Door),
-			*DoorDirectionToString(NewDoorDirection), *DoorSideToString(DoorSide), *DoorMotionToString(Motion));
-		
-		break;
+bool UDoorStatics::ResolveDoorTransition(EDoorState ClientDoorState, EDoorState DoorState, EDoorDirection DoorDirection,
+	EDoorAccess DoorAccess, EDoorOpenDirection DoorOpenDirection, EDoorSide DoorSide, EDoorMotion DoorOpenMotion,
+	EDoorState& NewDoorState, EDoorDirection& NewDoorDirection, EDoorMotion& Motion, FGameplayTag& FailReason)
+{
+	// Resolve the transition from the precomputed table
+	const uint16 Index = DoorTransition::PackIndex(ClientDoorState, DoorState, DoorDirection, DoorAccess,
+		DoorOpenDirection, DoorSide, DoorOpenMotion);
+	const uint8 Entry = DoorTransition::Table.Entries[Index];
+
+	NewDoorState = static_cast<EDoorState>(Entry & 0x3);
+	NewDoorDirection = static_cast<EDoorDirection>((Entry >> 2) & 0x1);
+
+	switch (static_cast<DoorTransition::EFail>((Entry >> 4) & 0x7))
+	{
+	case DoorTransition::Locked: FailReason = FDoorTags::Door_Fail_Locked; return false;
+	case DoorTransition::AlreadyClosed: FailReason = FDoorTags::Door_Fail_AlreadyClosed; return false;
+	case DoorTransition::AlreadyOpen: FailReason = FDoorTags::Door_Fail_AlreadyOpen; return false;
+	case DoorTransition::NoAccessFromFront: FailReason = FDoorTags::Door_Fail_NoAccessFromFront; return false;
+	case DoorTransition::NoAccessFromBack: FailReason = FDoorTags::Door_Fail_NoAccessFromBack; return false;
+	default: break;
 	}
 
+	Motion = static_cast<EDoorMotion>((Entry >> 3) & 0x1);
+	return true;
+}
+
+bool UDoorStatics::ProgressDoorState(const ADoor* Door, EDoorState DoorState, EDoorDirection DoorDirection,
+	EDoorSide DoorSide, EDoorState& NewDoorState, EDoorDirection& NewDoorDirection, EDoorMotion& Motion, FGameplayTag& FailReason)
+{
+	// Door is not valid
+	if (!IsValid(Door))
+	{
+		FailReason = FDoorTags::Door_Fail_DoorNotValid;
+		UE_LOG(LogDoors, Verbose, TEXT("UDoorStatics::ProgressDoorState: Door is not valid"));
+		return false;
+	}
+
+	if (!ResolveDoorTransition(DoorState, Door->GetDoorState(), Door->GetDoorDirection(), Door->GetDoorAccess(),
+		Door->GetDoorOpenDirection(), DoorSide, Door->GetDoorOpenMotion(), NewDoorState, NewDoorDirection, Motion, FailReason))
+	{
+		UE_LOG(LogDoors, Verbose, TEXT("%s UDoorStatics::ProgressDoorState: Failed with %s"), *GetRoleString(Door),
+			*FailReason.ToString());
+		return false;
+	}
+
+	UE_LOG(LogDoors, Verbose, TEXT("%s UDoorStatics::ProgressDoorState: %s door %s from %s with %s"), *GetRoleString(Door),
+		NewDoorState == EDoorState::Closing ? TEXT("Closing") : TEXT("Opening"),
+		*DoorDirectionToString(NewDoorDirection), *DoorSideToString(DoorSide), *DoorMotionToString(Motion));
+	
 	return true;
 }
 
@@ -214,14 +316,131 @@ EDoorSide UDoorStatics::GetDoorSide(const AActor* Avatar, const ADoor* Door)
 	{
 		return EDoorSide::Front;
 	}
-	const FVector DoorLocation = Door->GetDoorLocation();
-	const FVector AvatarLocation = Avatar->GetActorLocation();
-	const FVector DoorVector = Door->GetDoorTransform().GetScaledAxis(EAxis::X);
+	const FDoorSidePlane& Plane = Door->GetDoorSidePlane();
+	return GetDoorSideFromLocation(Avatar->GetActorLocation(), Plane.Location, Plane.Forward);
+}
+
+EDoorSide UDoorStatics::GetDoorSideFromLocation(const FVector& AvatarLocation, const FVector& DoorLocation,
+	const FVector& DoorForward)
+{
 	const FVector AvatarVector = (AvatarLocation - DoorLocation).GetSafeNormal2D();
-	const float Dot = FVector::DotProduct(DoorVector, AvatarVector);
+	const float Dot = FVector::DotProduct(DoorForward, AvatarVector);
 	return Dot >= 0.f ? EDoorSide::Front : EDoorSide::Back;
 }
 
+namespace DoorSide
+{
+	/**
+	 * Classify four avatars at a time, performing the same IEEE operations in the same order as
+	 * GetDoorSideFromLocation() so that results are identical: FMath::InvSqrt() is an exact sqrt and divide, and no
+	 * fused multiply-add or reciprocal estimate is used. The dot product is narrowed to float per lane, same as the
+	 * scalar path, so tiny negative dot products that round to -0.f remain in front
+	 */
+	static FORCEINLINE void ClassifyFour(const FVector* AvatarLocations, const FDoorSidePlane* Planes, int32 PlaneStride,
+		EDoorSide* OutSides)
+	{
+		const FDoorSidePlane& P0 = Planes[0];
+		const FDoorSidePlane& P1 = Planes[PlaneStride];
+		const FDoorSidePlane& P2 = Planes[PlaneStride * 2];
+		const FDoorSidePlane& P3 = Planes[PlaneStride * 3];
+
+		const VectorRegister4Double X = VectorSubtract(
+			MakeVectorRegisterDouble(AvatarLocations[0].X, AvatarLocations[1].X, AvatarLocations[2].X, AvatarLocations[3].X),
+			MakeVectorRegisterDouble(P0.Location.X, P1.Location.X, P2.Location.X, P3.Location.X));
+		const VectorRegister4Double Y = VectorSubtract(
+			MakeVectorRegisterDouble(AvatarLocations[0].Y, AvatarLocations[1].Y, AvatarLocations[2].Y, AvatarLocations[3].Y),
+			MakeVectorRegisterDouble(P0.Location.Y, P1.Location.Y, P2.Location.Y, P3.Location.Y));
+
+		// FVector::GetSafeNormal2D()
+		const VectorRegister4Double SquareSum = VectorAdd(VectorMultiply(X, X), VectorMultiply(Y, Y));
+		const VectorRegister4Double Scale = VectorDivide(GlobalVectorConstants::DoubleOne, VectorSqrt(SquareSum));
+		const VectorRegister4Double NormalX = VectorMultiply(X, Scale);
+		const VectorRegister4Double NormalY = VectorMultiply(Y, Scale);
+
+		// FVector::DotProduct(), the normal has no Z but the forward's Z contributes a signed zero
+		const VectorRegister4Double ForwardX = MakeVectorRegisterDouble(P0.Forward.X, P1.Forward.X, P2.Forward.X, P3.Forward.X);
+		const VectorRegister4Double ForwardY = MakeVectorRegisterDouble(P0.Forward.Y, P1.Forward.Y, P2.Forward.Y, P3.Forward.Y);
+		const VectorRegister4Double ForwardZ = MakeVectorRegisterDouble(P0.Forward.Z, P1.Forward.Z, P2.Forward.Z, P3.Forward.Z);
+		const VectorRegister4Double Dot = VectorAdd(
+			VectorAdd(VectorMultiply(ForwardX, NormalX), VectorMultiply(ForwardY, NormalY)),
+			VectorMultiply(ForwardZ, GlobalVectorConstants::DoubleZero));
+
+		// GetSafeNormal2D() returns zero below the tolerance, which is in front of the door
+		const int32 ZeroMask = VectorMaskBits(VectorCompareLT(SquareSum, VectorSetFloat1(static_cast<double>(UE_SMALL_NUMBER))));
+
+		alignas(32) double Dots[4];
+		VectorStoreAligned(Dot, Dots);
+		for (int32 i = 0; i < 4; i++)
+		{
+			const float LaneDot = static_cast<float>(Dots[i]);
+			OutSides[i] = (ZeroMask & (1 << i)) || LaneDot >= 0.f ? EDoorSide::Front : EDoorSide::Back;
+		}
+	}
+
+	static void Classify(TConstArrayView<FVector> AvatarLocations, const FDoorSidePlane* Planes, int32 PlaneStride,
+		TArrayView<EDoorSide> OutSides)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(DoorSide::Classify);
+
+		const int32 Num = AvatarLocations.Num();
+		const int32 NumVectorized = Num & ~3;
+
+		int32 i = 0;
+		for (; i < NumVectorized; i += 4)
+		{
+			ClassifyFour(&AvatarLocations[i], Planes + i * PlaneStride, PlaneStride, &OutSides[i]);
+		}
+
+		// Remainder
+		for (; i < Num; i++)
+		{
+			const FDoorSidePlane& Plane = Planes[i * PlaneStride];
+			OutSides[i] = UDoorStatics::GetDoorSideFromLocation(AvatarLocations[i], Plane.Location, Plane.Forward);
+		}
+	}
+}
+
+void UDoorStatics::GetDoorSidesFromLocations(TConstArrayView<FVector> AvatarLocations, const FDoorSidePlane& Plane,
+	TArrayView<EDoorSide> OutSides)
+{
+	check(AvatarLocations.Num() == OutSides.Num());
+	DoorSide::Classify(AvatarLocations, &Plane, 0, OutSides);
+}
+
+void UDoorStatics::GetDoorSidesFromLocations(TConstArrayView<FVector> AvatarLocations,
+	TConstArrayView<FDoorSidePlane> Planes, TArrayView<EDoorSide> OutSides)
+{
+	check(AvatarLocations.Num() == Planes.Num() && AvatarLocations.Num() == OutSides.Num());
+	DoorSide::Classify(AvatarLocations, Planes.GetData(), 1, OutSides);
+}
+
+void UDoorStatics::GetDoorSides(const TArray<AActor*>& Avatars, const ADoor* Door, TArray<EDoorSide>& DoorSides)
+{
+	DoorSides.Init(EDoorSide::Front, Avatars.Num());
+	if (!IsValid(Door))
+	{
+		return;
+	}
+
+	TArray<FVector, TInlineAllocator<64>> AvatarLocations;
+	AvatarLocations.SetNumUninitialized(Avatars.Num());
+	for (int32 i = 0; i < Avatars.Num(); i++)
+	{
+		AvatarLocations[i] = IsValid(Avatars[i]) ? Avatars[i]->GetActorLocation() : FVector::ZeroVector;
+	}
+
+	GetDoorSidesFromLocations(AvatarLocations, Door->GetDoorSidePlane(), DoorSides);
+
+	// Invalid avatars are in front of the door, same as GetDoorSide()
+	for (int32 i = 0; i < Avatars.Num(); i++)
+	{
+		if (!IsValid(Avatars[i]))
+		{
+			DoorSides[i] = EDoorSide::Front;
+		}
+	}
+}
+
 ADoor* UDoorStatics::GetOwningDoorFromComponent(const USceneComponent* Component)
 {
 	if (!IsValid(Component) || !Component->GetOwner())
@@ -12,6 +12,9 @@ namespace FDoorTags
 	UE_DEFINE_GAMEPLAY_TAG(Door_Fail_InMotion, "Door.Fail.InMotion");
 	UE_DEFINE_GAMEPLAY_TAG(Door_Fail_ClientDoorSide, "Door.Fail.ClientDoorSide");
 	UE_DEFINE_GAMEPLAY_TAG(Door_Fail_CanChangeDoorState, "Door.Fail.CanChangeDoorState");
+	UE_DEFINE_GAMEPLAY_TAG(Door_Fail_RateLimited, "Door.Fail.RateLimited");
+	UE_DEFINE_GAMEPLAY_TAG(Door_Fail_Contested, "Door.Fail.Contested");
+	UE_DEFINE_GAMEPLAY_TAG(Door_Fail_DoorwayOccupied, "Door.Fail.DoorwayOccupied");
 	
 	UE_DEFINE_GAMEPLAY_TAG(Door_Fail_DoorNotValid, "Door.Fail.DoorNotValid");
 	UE_DEFINE_GAMEPLAY_TAG(Door_Fail_Locked, "Door.Fail.Locked");
@@ -11,6 +11,81 @@ DEFINE_LOG_CATEGORY(LogDoors);
 #include UE_INLINE_GENERATED_CPP_BY_NAME(DoorTypes)
 
 FDoorAbilityTargetData::FDoorAbilityTargetData(const EDoorState& InDoorState, const EDoorDirection& InDoorDirection,
-	const EDoorSide& InDoorSide)
+	const EDoorSide& InDoorSide, float InClientTimestamp, uint8 InPredictionId)
 	: PackedState(UDoorStatics::PackTargetDataDoorState(InDoorState, InDoorDirection, InDoorSide))
+	, ClientTimestamp(InClientTimestamp)
+	, PredictionId(InPredictionId)
 {}
+
+namespace DoorTargetDataPool
+{
+	static constexpr int32 NumBlocks = 256;
+	static constexpr SIZE_T BlockAlignment = FMath::Max<SIZE_T>(alignof(FDoorAbilityTargetData), 16);
+	static constexpr SIZE_T BlockSize = Align(sizeof(FDoorAbilityTargetData), BlockAlignment);
+
+	/** Free blocks store the next free block in place */
+	struct FFreeBlock
+	{
+		FFreeBlock* Next;
+	};
+
+	alignas(BlockAlignment) static uint8 Storage[NumBlocks * BlockSize];
+
+	static FFreeBlock* FreeHead = nullptr;
+	static int32 NumUnusedBlocks = NumBlocks;
+	static FCriticalSection Lock;
+
+	static std::atomic<int32> NumHeapAllocations = 0;
+
+	static bool IsFromPool(const void* Ptr)
+	{
+		return Ptr >= Storage && Ptr < Storage + NumBlocks * BlockSize;
+	}
+}
+
+void* FDoorAbilityTargetData::operator new(size_t Size)
+{
+	using namespace DoorTargetDataPool;
+	if (Size <= BlockSize)
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (FreeHead)
+		{
+			FFreeBlock* Block = FreeHead;
+			FreeHead = Block->Next;
+			return Block;
+		}
+
+		// Blocks that have never been used are handed out in order
+		if (NumUnusedBlocks > 0)
+		{
+			return Storage + (NumBlocks - NumUnusedBlocks--) * BlockSize;
+		}
+	}
+	++NumHeapAllocations;
+	return FMemory::Malloc(Size, BlockAlignment);
+}
+
+void FDoorAbilityTargetData::operator delete(void* Ptr)
+{
+	using namespace DoorTargetDataPool;
+	if (!Ptr)
+	{
+		return;
+	}
+	
+	if (IsFromPool(Ptr))
+	{
+		FScopeLock ScopeLock(&Lock);
+		FFreeBlock* Block = static_cast<FFreeBlock*>(Ptr);
+		Block->Next = FreeHead;
+		FreeHead = Block;
+		return;
+	}
+	FMemory::Free(Ptr);
+}
+
+int32 FDoorAbilityTargetData::GetNumHeapAllocations()
+{
+	return DoorTargetDataPool::NumHeapAllocations;
+}
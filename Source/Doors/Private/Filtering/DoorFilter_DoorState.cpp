@@ -7,6 +7,7 @@
 #include "GraspComponent.h"
 #include "GraspStatics.h"
 #include "Components/PrimitiveComponent.h"
+#include "Types/TargetingSystemTypes.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(DoorFilter_DoorState)
 
@@ -15,6 +16,77 @@ UDoorFilter_DoorState::UDoorFilter_DoorState(const FObjectInitializer& ObjectIni
 	: Super(ObjectInitializer)
 {}
 
+void UDoorFilter_DoorState::PostInitProperties()
+{
+	Super::PostInitProperties();
+	
+	CompileDoorFilter();
+}
+
+void UDoorFilter_DoorState::PostLoad()
+{
+	Super::PostLoad();
+	
+	CompileDoorFilter();
+}
+
+#if WITH_EDITOR
+void UDoorFilter_DoorState::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	
+	CompileDoorFilter();
+}
+#endif
+
+void UDoorFilter_DoorState::CompileDoorFilter()
+{
+	AllowedDoorFilterBits = CompileFilterList(DoorStateFilterType, DoorStates, 4, 0)
+		| CompileFilterList(DoorDirectionFilterType, DoorDirections, 2, 4)
+		| CompileFilterList(DoorAccessFilterType, DoorAccesses, 3, 6)
+		| CompileFilterList(DoorOpenDirectionFilterType, DoorOpenDirections, 4, 9);
+}
+
+uint16 UDoorFilter_DoorState::GetDoorFilterBits(const ADoor* Door)
+{
+	return static_cast<uint16>((1 << static_cast<int32>(Door->GetDoorState()))
+		| (1 << (static_cast<int32>(Door->GetDoorDirection()) + 4))
+		| (1 << (static_cast<int32>(Door->GetDoorAccess()) + 6))
+		| (1 << (static_cast<int32>(Door->GetDoorOpenDirection()) + 9)));
+}
+
+void UDoorFilter_DoorState::Execute(const FTargetingRequestHandle& TargetingHandle) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(DoorFilter_DoorState::Execute);
+
+	// Skip UTargetingFilterTask_BasicFilterTemplate, we filter every target here
+	UTargetingTask::Execute(TargetingHandle);
+
+	SetTaskAsyncState(TargetingHandle, ETargetingTaskAsyncState::Executing);
+
+	if (TargetingHandle.IsValid())
+	{
+		if (FTargetingDefaultResultsSet* ResultData = FTargetingDefaultResultsSet::Find(TargetingHandle))
+		{
+			// Find the source actor once for every target
+			const FTargetingSourceContext* SourceContext = FTargetingSourceContext::Find(TargetingHandle);
+			if (!SourceContext || !IsValid(SourceContext->SourceActor))
+			{
+				ResultData->TargetResults.Reset();
+			}
+			else
+			{
+				ResultData->TargetResults.RemoveAllSwap([this](const FTargetingDefaultResultData& TargetData)
+				{
+					return ShouldFilterDoorTarget(TargetData);
+				});
+			}
+		}
+	}
+
+	SetTaskAsyncState(TargetingHandle, ETargetingTaskAsyncState::Completed);
+}
+
 bool UDoorFilter_DoorState::ShouldFilterTarget(const FTargetingRequestHandle& TargetingHandle,
 	const FTargetingDefaultResultData& TargetData) const
 {
@@ -26,34 +98,20 @@ bool UDoorFilter_DoorState::ShouldFilterTarget(const FTargetingRequestHandle& Ta
 	{
 		return true;
 	}
-	
+
+	return ShouldFilterDoorTarget(TargetData);
+}
+
+bool UDoorFilter_DoorState::ShouldFilterDoorTarget(const FTargetingDefaultResultData& TargetData) const
+{
+	// Selection from the door spatial index reports the door without a hit component
 	const UPrimitiveComponent* TargetComponent = TargetData.HitResult.GetComponent();
-	
-	const ADoor* Door = TargetComponent ? Cast<ADoor>(TargetComponent->GetOwner()) : nullptr;
+	const ADoor* Door = TargetComponent ? Cast<ADoor>(TargetComponent->GetOwner()) : Cast<ADoor>(TargetData.HitResult.GetActor());
 	if (!Door)
 	{
 		return bFilterIfNotDoor;
 	}
 
-	if (IsValueFiltered(DoorStateFilterType, Door->GetDoorState(), DoorStates))
-	{
-		return true;
-	}
-
-	if (IsValueFiltered(DoorDirectionFilterType, Door->GetDoorDirection(), DoorDirections))
-	{
-		return true;
-	}
-
-	if (IsValueFiltered(DoorAccessFilterType, Door->GetDoorAccess(), DoorAccesses))
-	{
-		return true;
-	}
-
-	if (IsValueFiltered(DoorOpenDirectionFilterType, Door->GetDoorOpenDirection(), DoorOpenDirections))
-	{
-		return true;
-	}
-
-	return false;
+	// Filtered if any of the door's bits are not allowed
+	return (GetDoorFilterBits(Door) & ~AllowedDoorFilterBits) != 0;
 }
@@ -0,0 +1,128 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "Filtering/DoorSelection_SpatialIndex.h"
+
+#include "Door.h"
+#include "GraspableComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "System/DoorSpatialSubsystem.h"
+#include "Types/TargetingSystemTypes.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DoorSelection_SpatialIndex)
+
+
+UDoorSelection_SpatialIndex::UDoorSelection_SpatialIndex(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{}
+
+void UDoorSelection_SpatialIndex::Execute(const FTargetingRequestHandle& TargetingHandle) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(DoorSelection_SpatialIndex::Execute);
+	
+	Super::Execute(TargetingHandle);
+
+	SetTaskAsyncState(TargetingHandle, ETargetingTaskAsyncState::Executing);
+
+	const FTargetingSourceContext* SourceContext = TargetingHandle.IsValid() ? FTargetingSourceContext::Find(TargetingHandle) : nullptr;
+	const AActor* SourceActor = SourceContext ? SourceContext->SourceActor.Get() : nullptr;
+	const UDoorSpatialSubsystem* SpatialSubsystem = IsValid(SourceActor) ? SourceActor->GetWorld()->GetSubsystem<UDoorSpatialSubsystem>() : nullptr;
+	if (!SpatialSubsystem)
+	{
+		SetTaskAsyncState(TargetingHandle, ETargetingTaskAsyncState::Completed);
+		return;
+	}
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	SourceActor->GetActorEyesViewPoint(ViewLocation, ViewRotation);
+	const FVector ViewDirection = ViewRotation.Vector();
+	const double MinDot = FMath::Cos(FMath::DegreesToRadians(ViewConeHalfAngle));
+	const double IgnoreViewConeDistSquared = FMath::Square<double>(IgnoreViewConeDistance);
+
+	// Gather doors within reach and view, nearest first
+	const FDoorSpatialIndex& Index = SpatialSubsystem->GetIndex();
+	TArray<TPair<double, int32>, TInlineAllocator<16>> Candidates;
+	Index.ForEachInRadius(ViewLocation, Reach, DoorSpatialAllStates,
+		[&](const FDoorSpatialEntry& Entry, int32 EntryIndex, double DistSquared)
+	{
+		if (DistSquared > IgnoreViewConeDistSquared)
+		{
+			const FVector ToDoor = (Entry.Location - ViewLocation) * FMath::InvSqrt(DistSquared);
+			if (FVector::DotProduct(ViewDirection, ToDoor) < MinDot)
+			{
+				return;
+			}
+		}
+		Candidates.Add({ DistSquared, EntryIndex });
+	});
+
+	if (Candidates.IsEmpty())
+	{
+		SetTaskAsyncState(TargetingHandle, ETargetingTaskAsyncState::Completed);
+		return;
+	}
+	
+	Candidates.Sort([](const TPair<double, int32>& A, const TPair<double, int32>& B) { return A.Key < B.Key; });
+
+	// Emit results directly, there is no hit to report so we describe each graspable component's location instead
+	FTargetingDefaultResultsSet& Results = FTargetingDefaultResultsSet::FindOrAdd(TargetingHandle);
+	TInlineComponentArray<UPrimitiveComponent*> Components;
+	int32 NumSelected = 0;
+	for (const TPair<double, int32>& Candidate : Candidates)
+	{
+		if (NumSelected >= MaxTargets)
+		{
+			break;
+		}
+
+		const FDoorSpatialEntry& Entry = Index.Entries[Candidate.Value];
+		ADoor* Door = Entry.Door.Get();
+		if (!IsValid(Door))
+		{
+			continue;
+		}
+
+		// Grasp interacts with graspable components, a door without any can't be interacted with
+		Door->GetComponents<UPrimitiveComponent>(Components);
+		bool bSelected = false;
+		for (UPrimitiveComponent* Component : Components)
+		{
+			if (!Component->Implements<UGraspableComponent>())
+			{
+				continue;
+			}
+			
+			// Another selection task may already have found this component
+			const bool bAlreadySelected = Results.TargetResults.ContainsByPredicate([Component](const FTargetingDefaultResultData& Result)
+			{
+				return Result.HitResult.GetComponent() == Component;
+			});
+			if (bAlreadySelected)
+			{
+				continue;
+			}
+
+			const FVector Location = Component->GetComponentLocation();
+			FTargetingDefaultResultData& Result = Results.TargetResults.AddDefaulted_GetRef();
+			Result.HitResult.HitObjectHandle = FActorInstanceHandle(Door);
+			Result.HitResult.Component = Component;
+			Result.HitResult.bBlockingHit = true;
+			Result.HitResult.TraceStart = ViewLocation;
+			Result.HitResult.TraceEnd = Location;
+			Result.HitResult.Location = Location;
+			Result.HitResult.ImpactPoint = Location;
+			Result.HitResult.Distance = FVector::Dist(ViewLocation, Location);
+			Result.HitResult.Normal = (ViewLocation - Location).GetSafeNormal();
+			Result.HitResult.ImpactNormal = Result.HitResult.Normal;
+			bSelected = true;
+		}
+		
+		if (bSelected)
+		{
+			NumSelected++;
+		}
+	}
+
+	SetTaskAsyncState(TargetingHandle, ETargetingTaskAsyncState::Completed);
+}
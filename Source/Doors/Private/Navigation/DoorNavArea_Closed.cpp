@@ -0,0 +1,15 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "Navigation/DoorNavArea_Closed.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DoorNavArea_Closed)
+
+
+UDoorNavArea_Closed::UDoorNavArea_Closed(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	DefaultCost = 1.f;
+	FixedAreaEnteringCost = 100.f;
+	DrawColor = FColor(255, 160, 0);
+}
@@ -0,0 +1,100 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "Navigation/DoorNavLinkComponent.h"
+
+#include "Door.h"
+#include "Navigation/DoorNavArea_Closed.h"
+#include "NavAreas/NavArea_Default.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "System/DoorTraversalSubsystem.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DoorNavLinkComponent)
+
+
+UDoorNavLinkComponent::UDoorNavLinkComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	OpenAreaClass = UNavArea_Default::StaticClass();
+	ClosedAreaClass = UDoorNavArea_Closed::StaticClass();
+
+	// Doors start closed, the door updates the link from its actual state on BeginPlay
+	EnabledAreaClass = ClosedAreaClass;
+}
+
+void UDoorNavLinkComponent::UpdateFromDoor(const ADoor* Door)
+{
+	if (!IsValid(Door))
+	{
+		return;
+	}
+
+	// SetEnabled() and SetEnabledArea() only update the off-mesh connection's area, the navmesh is not rebuilt
+	// The enabled area is only pushed to the navmesh while enabled, so set it first
+	const bool bCanPass = Door->CanAgentPassDoor(FromSide);
+	const TSubclassOf<UNavArea> AreaClass = Door->IsDoorOpenOrOpening() ? OpenAreaClass : ClosedAreaClass;
+	if (EnabledAreaClass != AreaClass)
+	{
+		SetEnabledArea(AreaClass);
+	}
+	if (IsEnabled() != bCanPass)
+	{
+		SetEnabled(bCanPass);
+	}
+}
+
+bool UDoorNavLinkComponent::OnLinkMoveStarted(UObject* PathComp, const FVector& DestPoint)
+{
+	// The path following component is owned by the agent's controller
+	UPathFollowingComponent* PathFollowingComponent = Cast<UPathFollowingComponent>(PathComp);
+	const AController* Controller = PathFollowingComponent ? Cast<AController>(PathFollowingComponent->GetOwner()) : nullptr;
+	APawn* Agent = Controller ? Controller->GetPawn() : nullptr;
+	
+	ADoor* Door = Cast<ADoor>(GetOwner());
+	if (Agent && Door)
+	{
+		// Pauses the agent's move until the door is open
+		if (UDoorTraversalSubsystem* TraversalSubsystem = GetWorld()->GetSubsystem<UDoorTraversalSubsystem>())
+		{
+			TraversalSubsystem->EnqueueAgent(Agent, Door, PathFollowingComponent);
+		}
+	}
+
+	return Super::OnLinkMoveStarted(PathComp, DestPoint);
+}
+
+void UDoorNavLinkComponent::OnRegister()
+{
+	UpdateLinkPoints();
+
+	Super::OnRegister();
+}
+
+#if WITH_EDITOR
+void UDoorNavLinkComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(ThisClass, FromSide) ||
+		PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(ThisClass, LinkDistance))
+	{
+		UpdateLinkPoints();
+	}
+
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+}
+#endif
+
+void UDoorNavLinkComponent::UpdateLinkPoints()
+{
+	// The front of the door faces the door's forward axis
+	const FVector FrontPoint = FVector(LinkDistance, 0.f, 0.f);
+	const FVector BackPoint = -FrontPoint;
+
+	// Assigned directly rather than with SetLinkData() which would refresh the navigation octree
+	// We are either not registered yet, or being edited and about to be re-registered
+	const bool bFromFront = FromSide == EDoorSide::Front;
+	LinkRelativeStart = bFromFront ? FrontPoint : BackPoint;
+	LinkRelativeEnd = bFromFront ? BackPoint : FrontPoint;
+	LinkDirection = ENavLinkDirection::LeftToRight;
+}
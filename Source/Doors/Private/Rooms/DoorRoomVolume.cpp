@@ -0,0 +1,51 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "Rooms/DoorRoomVolume.h"
+
+#include "Components/BrushComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/World.h"
+#include "System/DoorPortalSubsystem.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DoorRoomVolume)
+
+
+ADoorRoomVolume::ADoorRoomVolume(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// Rooms are resolved from their bounds, they don't need collision
+	GetBrushComponent()->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+	GetBrushComponent()->SetGenerateOverlapEvents(false);
+	GetBrushComponent()->SetCanEverAffectNavigation(false);
+}
+
+void ADoorRoomVolume::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UDoorPortalSubsystem* PortalSubsystem = GetWorld()->GetSubsystem<UDoorPortalSubsystem>())
+	{
+		PortalSubsystem->RegisterRoom(this);
+	}
+}
+
+void ADoorRoomVolume::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UDoorPortalSubsystem* PortalSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UDoorPortalSubsystem>() : nullptr)
+	{
+		PortalSubsystem->UnregisterRoom(this);
+	}
+	
+	Super::EndPlay(EndPlayReason);
+}
+
+FTransform ADoorRoomVolume::GetRoomTransform() const
+{
+	return GetBrushComponent()->GetComponentTransform();
+}
+
+FBox ADoorRoomVolume::GetRoomLocalBounds() const
+{
+	return GetBrushComponent()->CalcBounds(FTransform::Identity).GetBox();
+}
@@ -0,0 +1,388 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "System/DoorAsyncPhysicsSubsystem.h"
+
+#include "Door.h"
+#include "Engine/World.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PBDRigidsSolver.h"
+#include "PhysicsProxy/SingleParticlePhysicsProxy.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DoorAsyncPhysicsSubsystem)
+
+namespace DoorAsyncPhysicsCVars
+{
+	static bool bAsyncDoorMotionEnabled = true;
+	static FAutoConsoleVariableRef CVarAsyncDoorMotionEnabled(
+		TEXT("p.Door.AsyncPhysics.Enabled"),
+		bAsyncDoorMotionEnabled,
+		TEXT("If true, doors with bAsyncDoorMotion move in the physics step, applies to doors that begin play after it changes.\n"),
+		ECVF_Default);
+}
+
+namespace DoorAsyncPhysics
+{
+	/**
+	 * Kinematic targets are ignored by static bodies and fight the solver on simulated bodies
+	 * @return True if the leaf has a movable body that is not simulating
+	 */
+	static bool IsLeafKinematic(const UPrimitiveComponent* Leaf)
+	{
+		return Leaf->Mobility == EComponentMobility::Movable && Leaf->GetBodyInstance() &&
+			!Leaf->IsSimulatingPhysics();
+	}
+}
+
+// -------------------------------------------------------------
+// FDoorAsyncPhysicsCallback
+
+void FDoorAsyncPhysicsCallback::OnPreSimulate_Internal()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FDoorAsyncPhysicsCallback::OnPreSimulate_Internal);
+
+	// Apply changes from the game thread, the same input may be seen by several steps
+	if (const FDoorAsyncPhysicsInput* Input = GetConsumerInput_Internal())
+	{
+		for (const FDoorAsyncPhysicsCommand& Command : Input->Commands)
+		{
+			if (Command.bRemove)
+			{
+				Doors.Remove(Command.Id);
+				continue;
+			}
+
+			FDoor* Door = Doors.Find(Command.Id);
+			if (Door && Door->Revision >= Command.Revision)
+			{
+				continue;
+			}
+
+			if (!Door)
+			{
+				Door = &Doors.Add(Command.Id);
+			}
+			Door->Revision = Command.Revision;
+			Door->Proxy = Command.Proxy;
+			Door->ParentTransform = Command.ParentTransform;
+			Door->Motion = Command.Motion;
+			Door->TargetAlpha = Command.TargetAlpha;
+			Door->Rate = Command.Rate;
+			if (Command.bSetAlpha)
+			{
+				Door->Alpha = Command.Alpha;
+				Door->bDirty = true;
+			}
+		}
+	}
+
+	const float DeltaTime = GetDeltaTime_Internal();
+	FDoorAsyncPhysicsOutput& Output = GetProducerOutputData_Internal();
+
+	for (auto& DoorPair : Doors)
+	{
+		FDoor& Door = DoorPair.Value;
+		if (Door.Alpha == Door.TargetAlpha && !Door.bDirty)
+		{
+			continue;
+		}
+		Door.bDirty = false;
+
+		// Constant rate toward the target, which reaches it exactly so the game thread can finish the transition
+		Door.Alpha = FMath::FInterpConstantTo(Door.Alpha, Door.TargetAlpha, DeltaTime, Door.Rate);
+		Output.Alphas.Emplace(DoorPair.Key, Door.Alpha);
+
+		if (Chaos::FRigidBodyHandle_Internal* Handle = Door.Proxy ? Door.Proxy->GetPhysicsThreadAPI() : nullptr)
+		{
+			Handle->SetKinematicTarget(Door.Motion.GetRelativeTransform(Door.Alpha) * Door.ParentTransform);
+		}
+	}
+}
+
+// -------------------------------------------------------------
+// UDoorAsyncPhysicsSubsystem
+
+bool UDoorAsyncPhysicsSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDoorAsyncPhysicsSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (FPhysScene* PhysScene = InWorld.GetPhysicsScene())
+	{
+		if (Chaos::FPBDRigidsSolver* Solver = PhysScene->GetSolver())
+		{
+			Callback = Solver->CreateAndRegisterSimCallbackObject_External<FDoorAsyncPhysicsCallback>();
+		}
+	}
+}
+
+void UDoorAsyncPhysicsSubsystem::Deinitialize()
+{
+	if (Callback)
+	{
+		FPhysScene* PhysScene = GetWorld() ? GetWorld()->GetPhysicsScene() : nullptr;
+		if (Chaos::FPBDRigidsSolver* Solver = PhysScene ? PhysScene->GetSolver() : nullptr)
+		{
+			Solver->UnregisterAndFreeSimCallbackObject_External(Callback);
+		}
+		Callback = nullptr;
+	}
+
+	DoorIds.Empty();
+	Doors.Empty();
+	PendingCommands.Empty();
+	LatestAlphas.Empty();
+
+	Super::Deinitialize();
+}
+
+void UDoorAsyncPhysicsSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	ConsumeOutputs();
+	MoveSuspendedLeaves();
+	SendCommands();
+}
+
+TStatId UDoorAsyncPhysicsSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDoorAsyncPhysicsSubsystem, STATGROUP_Tickables);
+}
+
+bool UDoorAsyncPhysicsSubsystem::IsTickable() const
+{
+	return Callback != nullptr && (!Doors.IsEmpty() || !PendingCommands.IsEmpty());
+}
+
+bool UDoorAsyncPhysicsSubsystem::RegisterDoor(ADoor* Door)
+{
+	if (!Callback || !DoorAsyncPhysicsCVars::bAsyncDoorMotionEnabled || !IsValid(Door) || DoorIds.Contains(Door))
+	{
+		return false;
+	}
+
+	UPrimitiveComponent* Leaf = Door->GetDoorLeaf();
+	if (!Leaf)
+	{
+		return false;
+	}
+
+	if (!DoorAsyncPhysics::IsLeafKinematic(Leaf))
+	{
+		UE_LOG(LogDoors, Warning, TEXT("UDoorAsyncPhysicsSubsystem::RegisterDoor: %s leaf %s is not a movable, non-simulating body, moving it on the game thread instead"),
+			*GetNameSafe(Door), *GetNameSafe(Leaf));
+		return false;
+	}
+
+	FDoorLeafMotion Motion;
+	Motion.ClosedRelative = Leaf->GetRelativeTransform();
+	Motion.OpenRotation = Door->DoorLeafOpenRotation;
+	Motion.OpenOffset = Door->DoorLeafOpenOffset;
+
+	const int32 Id = NextId++;
+	FDoorAsyncPhysicsCommand Command;
+	if (!MakeCommand(Door, Id, Motion, Command))
+	{
+		return false;
+	}
+	Command.bSetAlpha = true;
+	PendingCommands.Add(Command);
+
+	DoorIds.Add(Door, Id);
+	Doors.Add(Id, { Door, Leaf, Motion });
+	Leaf->OnComponentPhysicsStateChanged.AddUniqueDynamic(this, &ThisClass::OnLeafPhysicsStateChanged);
+
+	// Match the leaf to the door's current alpha until the physics thread takes over
+	MoveLeaf(Leaf, Motion, Door->GetDoorAlpha());
+	return true;
+}
+
+void UDoorAsyncPhysicsSubsystem::UnregisterDoor(ADoor* Door)
+{
+	int32 Id;
+	if (DoorIds.RemoveAndCopyValue(Door, Id))
+	{
+		FDoorEntry Entry;
+		Doors.RemoveAndCopyValue(Id, Entry);
+		LatestAlphas.Remove(Id);
+
+		if (UPrimitiveComponent* Leaf = Entry.Leaf.Get())
+		{
+			Leaf->OnComponentPhysicsStateChanged.RemoveDynamic(this, &ThisClass::OnLeafPhysicsStateChanged);
+		}
+
+		if (!Entry.bSuspended)
+		{
+			SendRemove(Id);
+		}
+	}
+}
+
+void UDoorAsyncPhysicsSubsystem::SendRemove(int32 Id)
+{
+	// Commands that haven't been sent yet reference the same proxy
+	PendingCommands.RemoveAll([Id](const FDoorAsyncPhysicsCommand& Command) { return Command.Id == Id; });
+
+	if (FDoorAsyncPhysicsInput* Input = Callback ? Callback->GetProducerInputData_External() : nullptr)
+	{
+		FDoorAsyncPhysicsCommand& Command = Input->Commands.AddDefaulted_GetRef();
+		Command.Id = Id;
+		Command.bRemove = true;
+	}
+}
+
+void UDoorAsyncPhysicsSubsystem::OnLeafPhysicsStateChanged(UPrimitiveComponent* ChangedComponent,
+	EComponentPhysicsStateChange StateChange)
+{
+	ADoor* Door = ChangedComponent ? Cast<ADoor>(ChangedComponent->GetOwner()) : nullptr;
+	const int32* Id = Door ? DoorIds.Find(Door) : nullptr;
+	FDoorEntry* Entry = Id ? Doors.Find(*Id) : nullptr;
+	if (!Entry || Entry->Leaf != ChangedComponent)
+	{
+		return;
+	}
+
+	if (StateChange == EComponentPhysicsStateChange::Destroyed)
+	{
+		if (!Entry->bSuspended)
+		{
+			UE_LOG(LogDoors, Verbose, TEXT("UDoorAsyncPhysicsSubsystem::OnLeafPhysicsStateChanged: Suspending %s, its leaf lost its physics body"),
+				*GetNameSafe(Door));
+			
+			SendRemove(*Id);
+			LatestAlphas.Remove(*Id);
+			Entry->bSuspended = true;
+			Door->SetDoorMotionAsync(false);
+		}
+	}
+	else if (Entry->bSuspended && DoorAsyncPhysics::IsLeafKinematic(Entry->Leaf.Get()))
+	{
+		// The new body has a new proxy, overwrite the physics thread's alpha with where the door ticked to
+		// A new body that simulates stays on the game thread
+		FDoorAsyncPhysicsCommand Command;
+		if (MakeCommand(Door, *Id, Entry->Motion, Command))
+		{
+			UE_LOG(LogDoors, Verbose, TEXT("UDoorAsyncPhysicsSubsystem::OnLeafPhysicsStateChanged: Resuming %s"), *GetNameSafe(Door));
+			
+			Command.bSetAlpha = true;
+			PendingCommands.Add(Command);
+			Entry->bSuspended = false;
+			Door->SetDoorMotionAsync(true);
+		}
+	}
+}
+
+void UDoorAsyncPhysicsSubsystem::MoveSuspendedLeaves()
+{
+	for (const TPair<int32, FDoorEntry>& Entry : Doors)
+	{
+		const ADoor* Door = Entry.Value.bSuspended ? Entry.Value.Door.Get() : nullptr;
+		if (Door && Door->IsDoorInMotion())
+		{
+			MoveLeaf(Entry.Value.Leaf.Get(), Entry.Value.Motion, Door->GetDoorAlpha());
+		}
+	}
+}
+
+void UDoorAsyncPhysicsSubsystem::UpdateDoor(ADoor* Door)
+{
+	const int32* Id = DoorIds.Find(Door);
+	if (!Id || Doors[*Id].bSuspended)
+	{
+		return;
+	}
+
+	FDoorAsyncPhysicsCommand Command;
+	if (MakeCommand(Door, *Id, Doors[*Id].Motion, Command))
+	{
+		PendingCommands.Add(Command);
+	}
+}
+
+bool UDoorAsyncPhysicsSubsystem::MakeCommand(const ADoor* Door, int32 Id, const FDoorLeafMotion& Motion,
+	FDoorAsyncPhysicsCommand& OutCommand)
+{
+	const UPrimitiveComponent* Leaf = Door->GetDoorLeaf();
+	const FBodyInstance* BodyInstance = Leaf ? Leaf->GetBodyInstance() : nullptr;
+	if (!BodyInstance || !BodyInstance->GetPhysicsActorHandle())
+	{
+		return false;
+	}
+
+	const USceneComponent* Parent = Leaf->GetAttachParent();
+	
+	OutCommand.Id = Id;
+	OutCommand.Revision = ++NextRevision;
+	OutCommand.Proxy = BodyInstance->GetPhysicsActorHandle();
+	OutCommand.ParentTransform = Parent ? Parent->GetSocketTransform(Leaf->GetAttachSocketName()) : FTransform::Identity;
+	OutCommand.Motion = Motion;
+	OutCommand.Alpha = Door->GetDoorAlpha();
+
+	// Hold the leaf where the game thread last saw it while a pawn is in the doorway
+	const bool bHold = Door->IsDoorwayHoldActive();
+	OutCommand.bSetAlpha = Door->IsDoorStationary() || bHold;
+	OutCommand.TargetAlpha = bHold ? Door->GetDoorAlpha() : Door->GetTargetDoorAlpha();
+	OutCommand.Rate = Door->GetDoorAlphaRate();
+	return true;
+}
+
+void UDoorAsyncPhysicsSubsystem::MoveLeaf(UPrimitiveComponent* Leaf, const FDoorLeafMotion& Motion, float Alpha)
+{
+	if (!Leaf)
+	{
+		return;
+	}
+
+	const USceneComponent* Parent = Leaf->GetAttachParent();
+	const FTransform ParentTransform = Parent ? Parent->GetSocketTransform(Leaf->GetAttachSocketName()) : FTransform::Identity;
+	const FTransform Transform = Motion.GetRelativeTransform(Alpha) * ParentTransform;
+	Leaf->MoveComponent(Transform.GetLocation() - Leaf->GetComponentLocation(), Transform.GetRotation(), false, nullptr,
+		MOVECOMP_SkipPhysicsMove);
+}
+
+void UDoorAsyncPhysicsSubsystem::ConsumeOutputs()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDoorAsyncPhysicsSubsystem::ConsumeOutputs);
+
+	// Several steps may have run since the last tick, only the newest alpha matters
+	LatestAlphas.Reset();
+	while (Chaos::TSimCallbackOutputHandle<FDoorAsyncPhysicsOutput> Output = Callback->PopOutputData_External())
+	{
+		for (const TPair<int32, float>& Alpha : Output->Alphas)
+		{
+			LatestAlphas.Add(Alpha.Key, Alpha.Value);
+		}
+	}
+
+	for (const TPair<int32, float>& Alpha : LatestAlphas)
+	{
+		const FDoorEntry* Entry = Doors.Find(Alpha.Key);
+		ADoor* Door = Entry && !Entry->bSuspended ? Entry->Door.Get() : nullptr;
+		if (!Door)
+		{
+			continue;
+		}
+
+		MoveLeaf(Door->GetDoorLeaf(), Entry->Motion, Alpha.Value);
+		Door->SetDoorAlpha(Alpha.Value);
+	}
+}
+
+void UDoorAsyncPhysicsSubsystem::SendCommands()
+{
+	if (PendingCommands.IsEmpty())
+	{
+		return;
+	}
+
+	if (FDoorAsyncPhysicsInput* Input = Callback->GetProducerInputData_External())
+	{
+		Input->Commands.Append(PendingCommands);
+	}
+	PendingCommands.Reset();
+}
@@ -0,0 +1,229 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "System/DoorFixedSim.h"
+
+#include "Misc/Crc.h"
+
+namespace DoorFixedSimCVars
+{
+	static int32 TickRate = 60;
+	static FAutoConsoleVariableRef CVarTickRate(
+		TEXT("p.Door.Fixed.TickRate"),
+		TickRate,
+		TEXT("Ticks per second for doors using EAlphaMode::Fixed, must match on every machine simulating the door.\n"),
+		ECVF_Default);
+
+	static void TraceHash()
+	{
+		for (const EDoorEasing Easing : { EDoorEasing::Linear, EDoorEasing::SmoothStep })
+		{
+			UE_LOG(LogDoors, Display, TEXT("p.Door.Fixed.TraceHash: %s %08X"), *UEnum::GetValueAsString(Easing),
+				FDoorFixedSim::HashTraceScript(Easing));
+		}
+	}
+
+	static FAutoConsoleCommand CmdTraceHash(
+		TEXT("p.Door.Fixed.TraceHash"),
+		TEXT("Simulate a fixed input script with the deterministic door simulation and log the hash of its trace. Compare across machines and builds.\n"),
+		FConsoleCommandDelegate::CreateStatic(&TraceHash));
+}
+
+// -------------------------------------------------------------
+// FDoorFixedEaseTable
+
+int32 FDoorFixedEaseTable::Evaluate(int32 Phase) const
+{
+	static constexpr int32 SegmentShift = DoorFixedShift - DoorFixedEaseBits;
+	static constexpr int32 SegmentMask = (1 << SegmentShift) - 1;
+
+	Phase = FMath::Clamp<int32>(Phase, 0, DoorFixedOne);
+	const int32 Index = Phase >> SegmentShift;
+	if (Index >= DoorFixedEaseSegments)
+	{
+		return Values[DoorFixedEaseSegments];
+	}
+
+	const int64 Delta = static_cast<int64>(Values[Index + 1]) - Values[Index];
+	return Values[Index] + static_cast<int32>((Delta * (Phase & SegmentMask)) >> SegmentShift);
+}
+
+FDoorFixedEaseTable FDoorFixedEaseTable::MakeLinear()
+{
+	FDoorFixedEaseTable Table;
+	for (int32 i = 0; i <= DoorFixedEaseSegments; i++)
+	{
+		Table.Values[i] = i * (DoorFixedOne / DoorFixedEaseSegments);
+	}
+	return Table;
+}
+
+FDoorFixedEaseTable FDoorFixedEaseTable::MakeSmoothStep()
+{
+	FDoorFixedEaseTable Table;
+	for (int32 i = 0; i <= DoorFixedEaseSegments; i++)
+	{
+		const int64 X = i * (DoorFixedOne / DoorFixedEaseSegments);
+		Table.Values[i] = static_cast<int32>((X * X * (3 * static_cast<int64>(DoorFixedOne) - 2 * X)) >> (2 * DoorFixedShift));
+	}
+	return Table;
+}
+
+FDoorFixedEaseTable FDoorFixedEaseTable::Make(EDoorEasing Easing)
+{
+	switch (Easing)
+	{
+	case EDoorEasing::SmoothStep: return MakeSmoothStep();
+	default: return MakeLinear();
+	}
+}
+
+// -------------------------------------------------------------
+// FDoorFixedSimParams
+
+FDoorFixedSimParams FDoorFixedSimParams::Make(float OpenOutwardTime, float OpenInwardTime, float CloseOutwardTime,
+	float CloseInwardTime, int32 TicksPerSecond, EDoorEasing Easing)
+{
+	// The only float math, done once from the same properties on every machine
+	const auto ToTicks = [TicksPerSecond](float Time)
+	{
+		return FMath::Max<int32>(1, FMath::RoundToInt32(Time * TicksPerSecond));
+	};
+
+	FDoorFixedSimParams Params;
+	Params.OpenTicks[static_cast<uint8>(EDoorDirection::Outward)] = ToTicks(OpenOutwardTime);
+	Params.OpenTicks[static_cast<uint8>(EDoorDirection::Inward)] = ToTicks(OpenInwardTime);
+	Params.CloseTicks[static_cast<uint8>(EDoorDirection::Outward)] = ToTicks(CloseOutwardTime);
+	Params.CloseTicks[static_cast<uint8>(EDoorDirection::Inward)] = ToTicks(CloseInwardTime);
+	Params.Ease = FDoorFixedEaseTable::Make(Easing);
+	return Params;
+}
+
+// -------------------------------------------------------------
+// FDoorFixedSim
+
+void FDoorFixedSim::ApplyInput(EDoorState NewDoorState, EDoorDirection NewDoorDirection)
+{
+	State.DoorState = NewDoorState;
+	State.DoorDirection = NewDoorDirection;
+
+	switch (NewDoorState)
+	{
+	case EDoorState::Open: State.Phase = NewDoorDirection == EDoorDirection::Inward ? -DoorFixedOne : DoorFixedOne; break;
+	case EDoorState::Closed: State.Phase = 0; break;
+	default: break;
+	}
+}
+
+bool FDoorFixedSim::GetMotion(int32& OutTarget, int32& OutStepSize) const
+{
+	const uint8 DirectionIndex = static_cast<uint8>(State.DoorDirection) & 0x1;
+	int32 Ticks;
+	switch (State.DoorState)
+	{
+	case EDoorState::Opening:
+		OutTarget = State.DoorDirection == EDoorDirection::Inward ? -DoorFixedOne : DoorFixedOne;
+		Ticks = Params.OpenTicks[DirectionIndex];
+		break;
+	case EDoorState::Closing:
+		OutTarget = 0;
+		Ticks = Params.CloseTicks[DirectionIndex];
+		break;
+	default:
+		return false;
+	}
+
+	// Round up so the transition never takes longer than its ticks
+	OutStepSize = (DoorFixedOne + Ticks - 1) / FMath::Max<int32>(Ticks, 1);
+	return true;
+}
+
+void FDoorFixedSim::Step()
+{
+	State.Tick++;
+
+	int32 Target;
+	int32 StepSize;
+	if (!GetMotion(Target, StepSize))
+	{
+		return;
+	}
+
+	State.Phase = State.Phase < Target ? FMath::Min<int32>(State.Phase + StepSize, Target) : FMath::Max<int32>(State.Phase - StepSize, Target);
+
+	if (State.Phase == Target)
+	{
+		State.DoorState = State.DoorState == EDoorState::Opening ? EDoorState::Open : EDoorState::Closed;
+	}
+}
+
+int32 FDoorFixedSim::GetAlpha() const
+{
+	const int32 Eased = Params.Ease.Evaluate(FMath::Abs(State.Phase));
+	return State.Phase < 0 ? -Eased : Eased;
+}
+
+int32 FDoorFixedSim::GetRemainingTicks() const
+{
+	int32 Target;
+	int32 StepSize;
+	if (!GetMotion(Target, StepSize))
+	{
+		return 0;
+	}
+
+	const int32 Distance = FMath::Abs(Target - State.Phase);
+	return (Distance + StepSize - 1) / StepSize;
+}
+
+uint32 FDoorFixedSim::HashState(uint32 Hash) const
+{
+	const int32 Alpha = GetAlpha();
+	const uint8 StateBytes[2] = { static_cast<uint8>(State.DoorState), static_cast<uint8>(State.DoorDirection) };
+	Hash = FCrc::MemCrc32(&State.Tick, sizeof(State.Tick), Hash);
+	Hash = FCrc::MemCrc32(&State.Phase, sizeof(State.Phase), Hash);
+	Hash = FCrc::MemCrc32(&Alpha, sizeof(Alpha), Hash);
+	return FCrc::MemCrc32(StateBytes, sizeof(StateBytes), Hash);
+}
+
+uint32 FDoorFixedSim::HashTraceScript(EDoorEasing Easing)
+{
+	struct FInput
+	{
+		uint32 Tick;
+		EDoorState State;
+		EDoorDirection Direction;
+	};
+	static const FInput Script[] = {
+		{ 0, EDoorState::Opening, EDoorDirection::Outward },
+		{ 20, EDoorState::Closing, EDoorDirection::Outward },
+		{ 35, EDoorState::Opening, EDoorDirection::Inward },
+		{ 100, EDoorState::Closing, EDoorDirection::Inward },
+		{ 150, EDoorState::Open, EDoorDirection::Outward },
+		{ 160, EDoorState::Closing, EDoorDirection::Outward },
+	};
+
+	// Fixed params and tick rate, the trace must not depend on any setting
+	FDoorFixedSim Sim;
+	Sim.Params = FDoorFixedSimParams::Make(0.5f, 0.75f, 0.5f, 1.f, 60, Easing);
+
+	uint32 Hash = 0;
+	constexpr int32 NumInputs = UE_ARRAY_COUNT(Script);
+	int32 NextInput = 0;
+	for (uint32 Tick = 0; Tick < 240; Tick++)
+	{
+		while (NextInput < NumInputs && Script[NextInput].Tick == Tick)
+		{
+			Sim.ApplyInput(Script[NextInput].State, Script[NextInput].Direction);
+			NextInput++;
+		}
+		Sim.Step();
+		Hash = Sim.HashState(Hash);
+	}
+	return Hash;
+}
+
+int32 FDoorFixedSim::GetTicksPerSecond()
+{
+	return FMath::Max<int32>(DoorFixedSimCVars::TickRate, 1);
+}
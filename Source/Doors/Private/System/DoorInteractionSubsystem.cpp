@@ -0,0 +1,144 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "System/DoorInteractionSubsystem.h"
+
+#include "Door.h"
+#include "Engine/World.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DoorInteractionSubsystem)
+
+namespace DoorInteractionCVars
+{
+	static bool bRateLimitEnabled = true;
+	static FAutoConsoleVariableRef CVarRateLimitEnabled(
+		TEXT("p.Door.Interaction.RateLimit"),
+		bRateLimitEnabled,
+		TEXT("If true, each avatar has a token bucket that limits how often the server will evaluate their door interactions.\n"),
+		ECVF_Default);
+
+	static float BurstSize = 4.f;
+	static FAutoConsoleVariableRef CVarBurstSize(
+		TEXT("p.Door.Interaction.BurstSize"),
+		BurstSize,
+		TEXT("Maximum number of door interactions an avatar can make in quick succession before being rate limited.\n"),
+		ECVF_Default);
+
+	static float RefillRate = 4.f;
+	static FAutoConsoleVariableRef CVarRefillRate(
+		TEXT("p.Door.Interaction.RefillRate"),
+		RefillRate,
+		TEXT("How many door interactions per second an avatar regains after being rate limited.\n"),
+		ECVF_Default);
+
+	static bool bArbitrationEnabled = true;
+	static FAutoConsoleVariableRef CVarArbitrationEnabled(
+		TEXT("p.Door.Interaction.Arbitrate"),
+		bArbitrationEnabled,
+		TEXT("If true, only the first avatar to interact with a door each frame is evaluated, the rest are rejected as contested.\n"),
+		ECVF_Default);
+}
+
+bool UDoorInteractionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDoorInteractionSubsystem::Deinitialize()
+{
+	AvatarBuckets.Empty();
+	DoorClaims.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UDoorInteractionSubsystem::IsDoorContested(const ADoor* Door, const AActor* Avatar) const
+{
+	if (!DoorInteractionCVars::bArbitrationEnabled)
+	{
+		return false;
+	}
+	
+	const FDoorInteractionClaim* Claim = DoorClaims.Find(Door);
+	return Claim && Claim->Frame == GFrameCounter && Claim->Avatar.Get() != Avatar;
+}
+
+bool UDoorInteractionSubsystem::HasClaimedDoor(const ADoor* Door, const AActor* Avatar) const
+{
+	const FDoorInteractionClaim* Claim = DoorClaims.Find(Door);
+	return Claim && Claim->Frame == GFrameCounter && Claim->Avatar.Get() == Avatar;
+}
+
+bool UDoorInteractionSubsystem::ConsumeInteractionToken(const AActor* Avatar)
+{
+	if (!DoorInteractionCVars::bRateLimitEnabled || !IsValid(Avatar))
+	{
+		return true;
+	}
+
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+	PruneStaleEntries(TimeSeconds);
+
+	const float BurstSize = FMath::Max<float>(DoorInteractionCVars::BurstSize, 1.f);
+	
+	// New avatars start with a full bucket
+	FDoorInteractionBucket& Bucket = AvatarBuckets.FindOrAdd(Avatar);
+	if (Bucket.LastRefillTime < 0.f)
+	{
+		Bucket.Tokens = BurstSize;
+	}
+	else
+	{
+		const float Elapsed = TimeSeconds - Bucket.LastRefillTime;
+		Bucket.Tokens = FMath::Min<float>(BurstSize, Bucket.Tokens + Elapsed * FMath::Max<float>(DoorInteractionCVars::RefillRate, 0.f));
+	}
+	Bucket.LastRefillTime = TimeSeconds;
+
+	if (Bucket.Tokens < 1.f)
+	{
+		return false;
+	}
+
+	Bucket.Tokens -= 1.f;
+	return true;
+}
+
+void UDoorInteractionSubsystem::ClaimDoor(const ADoor* Door, const AActor* Avatar)
+{
+	if (DoorInteractionCVars::bArbitrationEnabled && IsValid(Door))
+	{
+		FDoorInteractionClaim& Claim = DoorClaims.FindOrAdd(Door);
+		Claim.Frame = GFrameCounter;
+		Claim.Avatar = Avatar;
+	}
+}
+
+void UDoorInteractionSubsystem::PruneStaleEntries(float TimeSeconds)
+{
+	// No need to do this often, the maps only grow with the number of avatars and doors interacted with
+	if (LastPruneTime >= 0.f && TimeSeconds - LastPruneTime < 5.f)
+	{
+		return;
+	}
+	LastPruneTime = TimeSeconds;
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDoorInteractionSubsystem::PruneStaleEntries);
+
+	// Buckets that have refilled are the same as having no bucket
+	const float RefillTime = FMath::Max<float>(DoorInteractionCVars::BurstSize, 1.f) / FMath::Max<float>(DoorInteractionCVars::RefillRate, UE_KINDA_SMALL_NUMBER);
+	for (auto It = AvatarBuckets.CreateIterator(); It; ++It)
+	{
+		if (!It->Key.IsValid() || TimeSeconds - It->Value.LastRefillTime >= RefillTime)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (auto It = DoorClaims.CreateIterator(); It; ++It)
+	{
+		if (!It->Key.IsValid() || It->Value.Frame != GFrameCounter)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
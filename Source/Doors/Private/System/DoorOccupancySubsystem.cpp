@@ -0,0 +1,171 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "System/DoorOccupancySubsystem.h"
+
+#include "Door.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DoorOccupancySubsystem)
+
+namespace DoorOccupancyCVars
+{
+	static float CellSize = 500.f;
+	static FAutoConsoleVariableRef CVarCellSize(
+		TEXT("p.Door.Occupancy.CellSize"),
+		CellSize,
+		TEXT("Size of each cell in the doorway occupancy grid, applies to worlds created after it changes.\n"),
+		ECVF_Default);
+}
+
+bool UDoorOccupancySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDoorOccupancySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	CellSize = FMath::Max<float>(DoorOccupancyCVars::CellSize, 1.f);
+
+	// Track every pawn, including those spawned later
+	for (TActorIterator<APawn> It(&InWorld); It; ++It)
+	{
+		Pawns.Add(*It);
+	}
+	ActorSpawnedHandle = InWorld.AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &ThisClass::OnActorSpawned));
+}
+
+void UDoorOccupancySubsystem::Deinitialize()
+{
+	if (GetWorld())
+	{
+		GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+
+	Pawns.Empty();
+	Occupants.Empty();
+	Cells.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UDoorOccupancySubsystem::IsDoorwayOccupied(const ADoor* Door)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDoorOccupancySubsystem::IsDoorwayOccupied);
+	
+	return !ForEachOccupant(Door, [](APawn*) { return false; });
+}
+
+int32 UDoorOccupancySubsystem::GetDoorwayOccupants(const ADoor* Door, TArray<APawn*>& OutPawns)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDoorOccupancySubsystem::GetDoorwayOccupants);
+	
+	OutPawns.Reset();
+	ForEachOccupant(Door, [&OutPawns](APawn* Pawn)
+	{
+		OutPawns.Add(Pawn);
+		return true;
+	});
+	return OutPawns.Num();
+}
+
+void UDoorOccupancySubsystem::OnActorSpawned(AActor* Actor)
+{
+	if (APawn* Pawn = Cast<APawn>(Actor))
+	{
+		Pawns.Add(Pawn);
+		
+		// Don't miss a pawn spawned into a doorway this frame
+		BuiltFrame = MAX_uint64;
+	}
+}
+
+void UDoorOccupancySubsystem::UpdateOccupants()
+{
+	if (BuiltFrame == GFrameCounter)
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDoorOccupancySubsystem::UpdateOccupants);
+
+	BuiltFrame = GFrameCounter;
+	Occupants.Reset();
+	Cells.Reset();
+	MaxOccupantRadius = 0.f;
+
+	Pawns.RemoveAllSwap([](const TWeakObjectPtr<APawn>& Pawn) { return !Pawn.IsValid(); });
+
+	for (const TWeakObjectPtr<APawn>& WeakPawn : Pawns)
+	{
+		const APawn* Pawn = WeakPawn.Get();
+		FDoorOccupant& Occupant = Occupants.AddDefaulted_GetRef();
+		Occupant.Pawn = WeakPawn;
+		Occupant.Location = Pawn->GetActorLocation();
+		Pawn->GetSimpleCollisionCylinder(Occupant.Radius, Occupant.HalfHeight);
+		MaxOccupantRadius = FMath::Max(MaxOccupantRadius, Occupant.Radius);
+		
+		Cells.FindOrAdd(GetCell(Occupant.Location)).Add(Occupants.Num() - 1);
+	}
+}
+
+template <typename FuncType>
+bool UDoorOccupancySubsystem::ForEachOccupant(const ADoor* Door, FuncType&& Func)
+{
+	if (!IsValid(Door))
+	{
+		return true;
+	}
+	
+	UpdateOccupants();
+	if (Occupants.IsEmpty())
+	{
+		return true;
+	}
+
+	// Doorway in door space, without scale, centered on GetDoorLocation()
+	const FTransform Transform = FTransform(Door->GetActorQuat(), Door->GetDoorSidePlane().Location);
+	const FVector Extent = Door->DoorwayExtent.ComponentMax(FVector::ZeroVector);
+	
+	const FBox Bounds = FBox(-Extent - MaxOccupantRadius, Extent + MaxOccupantRadius).TransformBy(Transform);
+	const FIntPoint Min = GetCell(Bounds.Min);
+	const FIntPoint Max = GetCell(Bounds.Max);
+	
+	for (int32 X = Min.X; X <= Max.X; X++)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+		{
+			const TArray<int32, TInlineAllocator<8>>* Cell = Cells.Find({ X, Y });
+			if (!Cell)
+			{
+				continue;
+			}
+
+			for (const int32 Index : *Cell)
+			{
+				// Test the pawn's cylinder against the doorway
+				const FDoorOccupant& Occupant = Occupants[Index];
+				const FVector Local = Transform.InverseTransformPositionNoScale(Occupant.Location);
+				if (FMath::Abs(Local.X) <= Extent.X + Occupant.Radius &&
+					FMath::Abs(Local.Y) <= Extent.Y + Occupant.Radius &&
+					FMath::Abs(Local.Z) <= Extent.Z + Occupant.HalfHeight)
+				{
+					APawn* Pawn = Occupant.Pawn.Get();
+					if (!IsValid(Pawn) || !Door->CanPawnBlockDoorway(Pawn))
+					{
+						continue;
+					}
+					if (!Func(Pawn))
+					{
+						return false;
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,692 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "System/DoorPortalSubsystem.h"
+
+#include "Door.h"
+#include "EngineUtils.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Rooms/DoorRoomVolume.h"
+#include "Algo/Reverse.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DoorPortalSubsystem)
+
+namespace DoorPortalCVars
+{
+	static bool bCullingEnabled = true;
+	static FAutoConsoleVariableRef CVarCullingEnabled(
+		TEXT("p.Door.Portal.Culling"),
+		bCullingEnabled,
+		TEXT("If true, static primitives in rooms that can't be seen through an open door are hidden from the local player's view.\n"),
+		ECVF_Default);
+
+	static float ProbeDistance = 50.f;
+	static FAutoConsoleVariableRef CVarProbeDistance(
+		TEXT("p.Door.Portal.ProbeDistance"),
+		ProbeDistance,
+		TEXT("Distance either side of the door to look for the rooms it connects, should exceed half the wall thickness.\n"),
+		ECVF_Default);
+
+	static float ClosedSoundTransmission = 0.25f;
+	static FAutoConsoleVariableRef CVarClosedSoundTransmission(
+		TEXT("p.Door.Propagation.ClosedSoundTransmission"),
+		ClosedSoundTransmission,
+		TEXT("Fraction of sound that passes through a fully closed door.\n"),
+		ECVF_Default);
+
+	static int32 OpennessSteps = 16;
+	static FAutoConsoleVariableRef CVarOpennessSteps(
+		TEXT("p.Door.Propagation.OpennessSteps"),
+		OpennessSteps,
+		TEXT("Door openness is quantized to this many steps for propagation, cached propagation is only recomputed when a door crosses a step.\n"),
+		ECVF_Default);
+}
+
+// -------------------------------------------------------------
+// FDoorPortalGraph
+
+FDoorPortalGraph::FDoorPortalGraph()
+{
+	FDoorPortalRoom& Outside = Rooms.AddDefaulted_GetRef();
+	Outside.bCullable = false;
+	Outside.bValid = true;
+}
+
+int32 FDoorPortalGraph::AddRoom(const FTransform& Transform, const FBox& LocalBounds, bool bCullable)
+{
+	const int32 Room = FreeRooms.Num() > 0 ? FreeRooms.Pop(EAllowShrinking::No) : Rooms.AddDefaulted();
+
+	FDoorPortalRoom& NewRoom = Rooms[Room];
+	NewRoom.Transform = Transform;
+	NewRoom.LocalBounds = LocalBounds;
+	NewRoom.bCullable = bCullable;
+	NewRoom.bValid = true;
+	return Room;
+}
+
+void FDoorPortalGraph::RemoveRoom(int32 Room)
+{
+	if (Room == DoorPortalOutside || !Rooms.IsValidIndex(Room) || !Rooms[Room].bValid)
+	{
+		return;
+	}
+
+	// Anything connected to the room is now connected to the outside
+	const TArray<int32, TInlineAllocator<4>> ConnectedPortals = Rooms[Room].Portals;
+	for (const int32 Portal : ConnectedPortals)
+	{
+		FDoorPortal& Connected = Portals[Portal];
+		SetPortalRooms(Portal,
+			Connected.Rooms[0] == Room ? DoorPortalOutside : Connected.Rooms[0],
+			Connected.Rooms[1] == Room ? DoorPortalOutside : Connected.Rooms[1]);
+	}
+
+	Rooms[Room] = FDoorPortalRoom();
+	FreeRooms.Add(Room);
+}
+
+int32 FDoorPortalGraph::AddPortal(ADoor* Door, int32 FrontRoom, int32 BackRoom)
+{
+	const int32 Portal = FreePortals.Num() > 0 ? FreePortals.Pop(EAllowShrinking::No) : Portals.AddDefaulted();
+
+	FDoorPortal& NewPortal = Portals[Portal];
+	NewPortal.Door = Door;
+	NewPortal.bValid = true;
+	NewPortal.Rooms[0] = INDEX_NONE;
+	NewPortal.Rooms[1] = INDEX_NONE;
+	SetPortalRooms(Portal, FrontRoom, BackRoom);
+	return Portal;
+}
+
+void FDoorPortalGraph::RemovePortal(int32 Portal)
+{
+	if (!Portals.IsValidIndex(Portal) || !Portals[Portal].bValid)
+	{
+		return;
+	}
+
+	for (const int32 Room : Portals[Portal].Rooms)
+	{
+		if (Rooms.IsValidIndex(Room))
+		{
+			Rooms[Room].Portals.RemoveSingleSwap(Portal, EAllowShrinking::No);
+		}
+	}
+
+	Portals[Portal] = FDoorPortal();
+	FreePortals.Add(Portal);
+}
+
+void FDoorPortalGraph::SetPortalRooms(int32 Portal, int32 FrontRoom, int32 BackRoom)
+{
+	FDoorPortal& Connected = Portals[Portal];
+	for (const int32 Room : Connected.Rooms)
+	{
+		if (Rooms.IsValidIndex(Room))
+		{
+			Rooms[Room].Portals.RemoveSingleSwap(Portal, EAllowShrinking::No);
+		}
+	}
+
+	Connected.Rooms[0] = FrontRoom;
+	Connected.Rooms[1] = BackRoom;
+	Rooms[FrontRoom].Portals.AddUnique(Portal);
+	Rooms[BackRoom].Portals.AddUnique(Portal);
+}
+
+bool FDoorPortalGraph::SetPortalOpenness(int32 Portal, float Openness, bool bOpen)
+{
+	FDoorPortal& Connected = Portals[Portal];
+	Connected.Openness = Openness;
+	if (Connected.bOpen != bOpen)
+	{
+		Connected.bOpen = bOpen;
+		return true;
+	}
+	return false;
+}
+
+int32 FDoorPortalGraph::FindRoom(const FVector& Location, int32 HintRoom) const
+{
+	if (HintRoom != DoorPortalOutside && Rooms.IsValidIndex(HintRoom) && Rooms[HintRoom].bValid &&
+		Rooms[HintRoom].Contains(Location))
+	{
+		return HintRoom;
+	}
+
+	for (int32 Room = DoorPortalOutside + 1; Room < Rooms.Num(); Room++)
+	{
+		if (Rooms[Room].bValid && Rooms[Room].Contains(Location))
+		{
+			return Room;
+		}
+	}
+	return DoorPortalOutside;
+}
+
+int32 FDoorPortalGraph::FindRoomContainingBox(const FBox& Box) const
+{
+	const int32 Room = FindRoom(Box.GetCenter());
+	return Room != DoorPortalOutside && Rooms[Room].ContainsBox(Box) ? Room : DoorPortalOutside;
+}
+
+void FDoorPortalGraph::ComputeVisibleRooms(int32 StartRoom, TBitArray<>& OutVisibleRooms) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FDoorPortalGraph::ComputeVisibleRooms);
+	
+	OutVisibleRooms.Init(false, Rooms.Num());
+	if (!Rooms.IsValidIndex(StartRoom))
+	{
+		return;
+	}
+
+	TArray<int32, TInlineAllocator<32>> Pending;
+	Pending.Add(StartRoom);
+	OutVisibleRooms[StartRoom] = true;
+
+	while (Pending.Num() > 0)
+	{
+		const int32 Room = Pending.Pop(EAllowShrinking::No);
+		for (const int32 Portal : Rooms[Room].Portals)
+		{
+			const FDoorPortal& Connected = Portals[Portal];
+			if (!Connected.bOpen)
+			{
+				continue;
+			}
+
+			const int32 OtherRoom = Connected.GetOtherRoom(Room);
+			if (!OutVisibleRooms[OtherRoom])
+			{
+				OutVisibleRooms[OtherRoom] = true;
+				Pending.Add(OtherRoom);
+			}
+		}
+	}
+}
+
+// -------------------------------------------------------------
+// FDoorPropagationCache
+
+float FDoorPropagationCache::GetPortalTransmission(const FDoorPortal& Portal, EDoorPropagation Propagation,
+	float ClosedSoundTransmission)
+{
+	switch (Propagation)
+	{
+	case EDoorPropagation::Sound: return FMath::Lerp<float>(FMath::Clamp<float>(ClosedSoundTransmission, 0.f, 1.f), 1.f, Portal.Openness);
+	case EDoorPropagation::Sight: return Portal.bOpen ? Portal.Openness : 0.f;
+	default: return 0.f;
+	}
+}
+
+void FDoorPropagationCache::InvalidatePortal(const FDoorPortalGraph& Graph, int32 Portal)
+{
+	if (!Graph.Portals.IsValidIndex(Portal))
+	{
+		return;
+	}
+
+	const FDoorPortal& Changed = Graph.Portals[Portal];
+	for (TArray<FDoorPropagationTree>& ChannelTrees : Trees)
+	{
+		for (FDoorPropagationTree& Tree : ChannelTrees)
+		{
+			if (Tree.Generation != Generation)
+			{
+				continue;
+			}
+
+			for (const int32 Room : Changed.Rooms)
+			{
+				if (!Tree.Transmission.IsValidIndex(Room) || Tree.Transmission[Room] > 0.f)
+				{
+					Tree.Generation = 0;
+					break;
+				}
+			}
+		}
+	}
+}
+
+const FDoorPropagationTree& FDoorPropagationCache::GetTree(const FDoorPortalGraph& Graph, int32 SourceRoom,
+	EDoorPropagation Propagation, float ClosedSoundTransmission)
+{
+	TArray<FDoorPropagationTree>& ChannelTrees = Trees[static_cast<uint8>(Propagation)];
+	if (ChannelTrees.Num() < Graph.Rooms.Num())
+	{
+		ChannelTrees.SetNum(Graph.Rooms.Num());
+	}
+
+	FDoorPropagationTree& Tree = ChannelTrees[SourceRoom];
+	if (Tree.Generation == Generation)
+	{
+		return Tree;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(FDoorPropagationCache::GetTree);
+	
+	Tree.Generation = Generation;
+	Tree.Transmission.Init(0.f, Graph.Rooms.Num());
+	Tree.ViaPortal.Init(INDEX_NONE, Graph.Rooms.Num());
+	Tree.Transmission[SourceRoom] = 1.f;
+
+	// Dijkstra maximizing the product of transmissions, which never increases along a path
+	struct FPending
+	{
+		float Transmission;
+		int32 Room;
+		bool operator<(const FPending& Other) const { return Transmission > Other.Transmission; }
+	};
+	TArray<FPending, TInlineAllocator<32>> Pending;
+	Pending.HeapPush({ 1.f, SourceRoom });
+
+	while (Pending.Num() > 0)
+	{
+		FPending Current;
+		Pending.HeapPop(Current, EAllowShrinking::No);
+		if (Current.Transmission < Tree.Transmission[Current.Room])
+		{
+			continue;  // Already reached through a better path
+		}
+
+		for (const int32 Portal : Graph.Rooms[Current.Room].Portals)
+		{
+			const FDoorPortal& Connected = Graph.Portals[Portal];
+			const int32 OtherRoom = Connected.GetOtherRoom(Current.Room);
+			const float Transmission = Current.Transmission * GetPortalTransmission(Connected, Propagation, ClosedSoundTransmission);
+			if (Transmission > Tree.Transmission[OtherRoom])
+			{
+				Tree.Transmission[OtherRoom] = Transmission;
+				Tree.ViaPortal[OtherRoom] = Portal;
+				Pending.HeapPush({ Transmission, OtherRoom });
+			}
+		}
+	}
+	
+	return Tree;
+}
+
+// -------------------------------------------------------------
+// UDoorPortalSubsystem
+
+bool UDoorPortalSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDoorPortalSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Streamed in levels have primitives to assign to rooms
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &ThisClass::OnLevelAddedToWorld);
+}
+
+void UDoorPortalSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+
+	for (auto& ViewPair : Views)
+	{
+		ClearView(ViewPair.Key.Get(), ViewPair.Value);
+	}
+	Views.Empty();
+	DoorPortals.Empty();
+	VolumeRooms.Empty();
+	RoomVolumes.Empty();
+	RoomPrimitives.Empty();
+	Graph = FDoorPortalGraph();
+
+	Super::Deinitialize();
+}
+
+void UDoorPortalSubsystem::Tick(float DeltaTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDoorPortalSubsystem::Tick);
+	
+	Super::Tick(DeltaTime);
+
+	if (!DoorPortalCVars::bCullingEnabled || VolumeRooms.IsEmpty())
+	{
+		// Restore anything we hid
+		for (auto& ViewPair : Views)
+		{
+			ClearView(ViewPair.Key.Get(), ViewPair.Value);
+		}
+		Views.Empty();
+		bVisibilityDirty = true;
+		return;
+	}
+
+	if (bRoomPrimitivesDirty)
+	{
+		GatherRoomPrimitives();
+		bVisibilityDirty = true;
+	}
+
+	// Remove views for players that no longer exist
+	for (auto It = Views.CreateIterator(); It; ++It)
+	{
+		if (!It->Key.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	TBitArray<> NewVisibleRooms;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		if (!PlayerController || !PlayerController->IsLocalController())
+		{
+			continue;
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		// Only walk the graph if the camera changed rooms or a portal opened or closed
+		FDoorPortalView& View = Views.FindOrAdd(PlayerController);
+		const int32 CameraRoom = Graph.FindRoom(ViewLocation, View.CameraRoom);
+		if (CameraRoom == View.CameraRoom && !bVisibilityDirty && View.VisibleRooms.Num() == Graph.Rooms.Num())
+		{
+			continue;
+		}
+
+		View.CameraRoom = CameraRoom;
+		Graph.ComputeVisibleRooms(CameraRoom, NewVisibleRooms);
+		if (NewVisibleRooms != View.VisibleRooms)
+		{
+			ApplyView(PlayerController, View, NewVisibleRooms);
+		}
+	}
+
+	bVisibilityDirty = false;
+}
+
+TStatId UDoorPortalSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDoorPortalSubsystem, STATGROUP_Tickables);
+}
+
+bool UDoorPortalSubsystem::IsTickable() const
+{
+	// Nothing to render, the graph is still used for propagation
+	const UWorld* World = GetWorld();
+	return World && World->GetNetMode() != NM_DedicatedServer;
+}
+
+void UDoorPortalSubsystem::RegisterRoom(ADoorRoomVolume* Room)
+{
+	if (!IsValid(Room) || VolumeRooms.Contains(Room))
+	{
+		return;
+	}
+
+	const int32 Index = Graph.AddRoom(Room->GetRoomTransform(), Room->GetRoomLocalBounds(), Room->bCullWhenNotVisible);
+	VolumeRooms.Add(Room, Index);
+	if (RoomVolumes.Num() <= Index)
+	{
+		RoomVolumes.SetNum(Index + 1);
+	}
+	RoomVolumes[Index] = Room;
+
+	ReprobeAllPortals();
+	bRoomPrimitivesDirty = true;
+	PropagationCache.Invalidate();
+}
+
+void UDoorPortalSubsystem::UnregisterRoom(ADoorRoomVolume* Room)
+{
+	int32 Index;
+	if (VolumeRooms.RemoveAndCopyValue(Room, Index))
+	{
+		Graph.RemoveRoom(Index);
+		RoomVolumes[Index] = nullptr;
+		
+		ReprobeAllPortals();
+		bRoomPrimitivesDirty = true;
+		PropagationCache.Invalidate();
+	}
+}
+
+void UDoorPortalSubsystem::RegisterDoor(ADoor* Door)
+{
+	if (!IsValid(Door) || DoorPortals.Contains(Door))
+	{
+		return;
+	}
+
+	int32 FrontRoom, BackRoom;
+	ProbeDoorRooms(Door, FrontRoom, BackRoom);
+	DoorPortals.Add(Door, Graph.AddPortal(Door, FrontRoom, BackRoom));
+	UpdateDoor(Door);
+	bVisibilityDirty = true;
+	PropagationCache.Invalidate();
+}
+
+void UDoorPortalSubsystem::UnregisterDoor(ADoor* Door)
+{
+	int32 Portal;
+	if (DoorPortals.RemoveAndCopyValue(Door, Portal))
+	{
+		Graph.RemovePortal(Portal);
+		bVisibilityDirty = true;
+		PropagationCache.Invalidate();
+	}
+}
+
+void UDoorPortalSubsystem::UpdateDoor(const ADoor* Door)
+{
+	if (const int32* Portal = DoorPortals.Find(Door))
+	{
+		// Quantized so a moving door doesn't recompute propagation every frame, 0 and 1 remain exact
+		const float Alpha = Door->GetDoorAlphaAbs();
+		const float Steps = static_cast<float>(FMath::Max<int32>(DoorPortalCVars::OpennessSteps, 1));
+		const bool bOpen = Door->GetDoorState() != EDoorState::Closed || !FMath::IsNearlyZero(Alpha);
+		const float Openness = FMath::Max<float>(FMath::RoundToFloat(Alpha * Steps), Alpha > 0.f ? 1.f : 0.f) / Steps;
+		const float OldOpenness = Graph.Portals[*Portal].Openness;
+		const bool bBlockingChanged = Graph.SetPortalOpenness(*Portal, Openness, bOpen);
+		if (bBlockingChanged)
+		{
+			bVisibilityDirty = true;
+		}
+		if (bBlockingChanged || Openness != OldOpenness)
+		{
+			PropagationCache.InvalidatePortal(Graph, *Portal);
+		}
+	}
+}
+
+void UDoorPortalSubsystem::UpdateDoorRooms(const ADoor* Door)
+{
+	if (const int32* Portal = DoorPortals.Find(Door))
+	{
+		int32 FrontRoom, BackRoom;
+		ProbeDoorRooms(Door, FrontRoom, BackRoom);
+		const FDoorPortal& Connected = Graph.Portals[*Portal];
+		if (Connected.Rooms[0] != FrontRoom || Connected.Rooms[1] != BackRoom)
+		{
+			Graph.SetPortalRooms(*Portal, FrontRoom, BackRoom);
+			bVisibilityDirty = true;
+			PropagationCache.Invalidate();
+		}
+	}
+}
+
+void UDoorPortalSubsystem::GetVisibleRooms(const FVector& ViewLocation, TArray<ADoorRoomVolume*>& OutRooms) const
+{
+	OutRooms.Reset();
+
+	TBitArray<> VisibleRooms;
+	Graph.ComputeVisibleRooms(Graph.FindRoom(ViewLocation), VisibleRooms);
+	for (TConstSetBitIterator<> It(VisibleRooms); It; ++It)
+	{
+		if (ADoorRoomVolume* Room = RoomVolumes.IsValidIndex(It.GetIndex()) ? RoomVolumes[It.GetIndex()].Get() : nullptr)
+		{
+			OutRooms.Add(Room);
+		}
+	}
+}
+
+ADoorRoomVolume* UDoorPortalSubsystem::GetRoomAtLocation(const FVector& Location) const
+{
+	const int32 Room = Graph.FindRoom(Location);
+	return Room != DoorPortalOutside && RoomVolumes.IsValidIndex(Room) ? RoomVolumes[Room].Get() : nullptr;
+}
+
+float UDoorPortalSubsystem::GetDoorTransmission(const FVector& From, const FVector& To, EDoorPropagation Propagation) const
+{
+	const int32 FromRoom = Graph.FindRoom(From);
+	const int32 ToRoom = Graph.FindRoom(To);
+	if (FromRoom == ToRoom)
+	{
+		return 1.f;
+	}
+
+	const FDoorPropagationTree& Tree = PropagationCache.GetTree(Graph, FromRoom, Propagation,
+		DoorPortalCVars::ClosedSoundTransmission);
+	return Tree.Transmission[ToRoom];
+}
+
+float UDoorPortalSubsystem::GetDoorPropagationPath(const FVector& From, const FVector& To, EDoorPropagation Propagation,
+	TArray<ADoor*>& OutDoors) const
+{
+	OutDoors.Reset();
+	
+	const int32 FromRoom = Graph.FindRoom(From);
+	const int32 ToRoom = Graph.FindRoom(To);
+	if (FromRoom == ToRoom)
+	{
+		return 1.f;
+	}
+
+	const FDoorPropagationTree& Tree = PropagationCache.GetTree(Graph, FromRoom, Propagation,
+		DoorPortalCVars::ClosedSoundTransmission);
+
+	// Walk back from the destination to the source
+	for (int32 Room = ToRoom; Tree.ViaPortal[Room] != INDEX_NONE; )
+	{
+		const FDoorPortal& Portal = Graph.Portals[Tree.ViaPortal[Room]];
+		OutDoors.Add(Portal.Door.Get());
+		Room = Portal.GetOtherRoom(Room);
+	}
+	Algo::Reverse(OutDoors);
+	
+	return Tree.Transmission[ToRoom];
+}
+
+void UDoorPortalSubsystem::ProbeDoorRooms(const ADoor* Door, int32& OutFrontRoom, int32& OutBackRoom) const
+{
+	const FDoorSidePlane& Plane = Door->GetDoorSidePlane();
+	const FVector Offset = Plane.Forward.GetSafeNormal2D() * DoorPortalCVars::ProbeDistance;
+	OutFrontRoom = Graph.FindRoom(Plane.Location + Offset);
+	OutBackRoom = Graph.FindRoom(Plane.Location - Offset);
+}
+
+void UDoorPortalSubsystem::ReprobeAllPortals()
+{
+	for (const auto& DoorPair : DoorPortals)
+	{
+		if (const ADoor* Door = DoorPair.Key.ResolveObjectPtr())
+		{
+			int32 FrontRoom, BackRoom;
+			ProbeDoorRooms(Door, FrontRoom, BackRoom);
+			Graph.SetPortalRooms(DoorPair.Value, FrontRoom, BackRoom);
+		}
+	}
+	bVisibilityDirty = true;
+}
+
+void UDoorPortalSubsystem::GatherRoomPrimitives()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDoorPortalSubsystem::GatherRoomPrimitives);
+
+	bRoomPrimitivesDirty = false;
+
+	// Primitives we hid may be moving to a different room
+	for (auto& ViewPair : Views)
+	{
+		ClearView(ViewPair.Key.Get(), ViewPair.Value);
+	}
+	
+	RoomPrimitives.Reset();
+	RoomPrimitives.SetNum(Graph.Rooms.Num());
+
+	// Only static actors can be assigned to a room once, anything that moves could leave it
+	TArray<UPrimitiveComponent*> Primitives;
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		const AActor* Actor = *It;
+		if (Actor->IsA<ADoor>() || Actor->IsA<ADoorRoomVolume>() || !Actor->IsRootComponentStatic())
+		{
+			continue;
+		}
+
+		Actor->GetComponents(Primitives);
+		for (UPrimitiveComponent* Primitive : Primitives)
+		{
+			if (Primitive->Mobility != EComponentMobility::Static)
+			{
+				continue;
+			}
+			
+			// Floors, walls and ceilings spanning rooms are visible from each of them, leave them unmanaged
+			const int32 Room = Graph.FindRoomContainingBox(Primitive->Bounds.GetBox());
+			if (Room != DoorPortalOutside && Graph.Rooms[Room].bCullable)
+			{
+				RoomPrimitives[Room].Add(Primitive);
+			}
+		}
+	}
+}
+
+void UDoorPortalSubsystem::OnLevelAddedToWorld(ULevel* Level, UWorld* World)
+{
+	if (World == GetWorld())
+	{
+		bRoomPrimitivesDirty = true;
+	}
+}
+
+void UDoorPortalSubsystem::ApplyView(APlayerController* PlayerController, FDoorPortalView& View,
+	const TBitArray<>& NewVisibleRooms)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDoorPortalSubsystem::ApplyView);
+	
+	ClearView(PlayerController, View);
+	View.VisibleRooms = NewVisibleRooms;
+
+	for (int32 Room = DoorPortalOutside + 1; Room < RoomPrimitives.Num(); Room++)
+	{
+		if (!NewVisibleRooms[Room])
+		{
+			View.HiddenPrimitives.Append(RoomPrimitives[Room]);
+		}
+	}
+	PlayerController->HiddenPrimitiveComponents.Append(View.HiddenPrimitives);
+}
+
+void UDoorPortalSubsystem::ClearView(APlayerController* PlayerController, FDoorPortalView& View)
+{
+	if (PlayerController && View.HiddenPrimitives.Num() > 0)
+	{
+		TSet<const UPrimitiveComponent*> Hidden;
+		Hidden.Reserve(View.HiddenPrimitives.Num());
+		for (const TWeakObjectPtr<UPrimitiveComponent>& Primitive : View.HiddenPrimitives)
+		{
+			Hidden.Add(Primitive.Get());
+		}
+
+		PlayerController->HiddenPrimitiveComponents.RemoveAllSwap([&Hidden](const TWeakObjectPtr<UPrimitiveComponent>& Primitive)
+		{
+			return !Primitive.IsValid() || Hidden.Contains(Primitive.Get());
+		});
+	}
+	
+	View.HiddenPrimitives.Reset();
+	View.VisibleRooms.Reset();
+}
@@ -0,0 +1,363 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "System/DoorProximitySubsystem.h"
+
+#include "Door.h"
+#include "DoorStatics.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "System/DoorTraversalSubsystem.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DoorProximitySubsystem)
+
+namespace DoorProximityCVars
+{
+	static float UpdateRate = 15.f;
+	static FAutoConsoleVariableRef CVarUpdateRate(
+		TEXT("p.Door.Auto.UpdateRate"),
+		UpdateRate,
+		TEXT("How many times per second pawns are tested against automatic door triggers. 0 to test every frame.\n"),
+		ECVF_Default);
+
+	static float CellSize = 500.f;
+	static FAutoConsoleVariableRef CVarCellSize(
+		TEXT("p.Door.Auto.CellSize"),
+		CellSize,
+		TEXT("Size of each cell in the automatic door spatial hash, applies to worlds created after it changes.\n"),
+		ECVF_Default);
+
+	static float PredictionTimeout = 1.f;
+	static FAutoConsoleVariableRef CVarPredictionTimeout(
+		TEXT("p.Door.Auto.PredictionTimeout"),
+		PredictionTimeout,
+		TEXT("How long a client predicted automatic door waits for the server to open it before applying the server's state.\n"),
+		ECVF_Default);
+}
+
+bool UDoorProximitySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDoorProximitySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	CellSize = FMath::Max<float>(DoorProximityCVars::CellSize, 1.f);
+
+	// Track every pawn, including those spawned later
+	for (TActorIterator<APawn> It(&InWorld); It; ++It)
+	{
+		Pawns.Add(*It);
+	}
+	ActorSpawnedHandle = InWorld.AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &ThisClass::OnActorSpawned));
+}
+
+void UDoorProximitySubsystem::Deinitialize()
+{
+	if (GetWorld())
+	{
+		GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+	
+	Entries.Empty();
+	FreeEntries.Empty();
+	DoorEntries.Empty();
+	Cells.Empty();
+	Pawns.Empty();
+
+	Super::Deinitialize();
+}
+
+void UDoorProximitySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+	if (DoorProximityCVars::UpdateRate > 0.f && LastUpdateTime >= 0.f &&
+		TimeSeconds - LastUpdateTime < 1.f / DoorProximityCVars::UpdateRate)
+	{
+		return;
+	}
+
+	LastUpdateTime = TimeSeconds;
+	UpdateProximity(TimeSeconds);
+}
+
+TStatId UDoorProximitySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDoorProximitySubsystem, STATGROUP_Tickables);
+}
+
+bool UDoorProximitySubsystem::IsTickable() const
+{
+	// Clients only register doors they predict
+	return !DoorEntries.IsEmpty();
+}
+
+void UDoorProximitySubsystem::RegisterDoor(ADoor* Door)
+{
+	if (!IsValid(Door) || DoorEntries.Contains(Door))
+	{
+		return;
+	}
+
+	const int32 Index = FreeEntries.Num() > 0 ? FreeEntries.Pop(EAllowShrinking::No) : Entries.AddDefaulted();
+	Entries[Index].Door = Door;
+	Entries[Index].bValid = true;
+	DoorEntries.Add(Door, Index);
+	UpdateDoor(Door);
+}
+
+void UDoorProximitySubsystem::UnregisterDoor(ADoor* Door)
+{
+	int32 Index;
+	if (DoorEntries.RemoveAndCopyValue(Door, Index))
+	{
+		RemoveFromCells(Index);
+		Entries[Index] = FDoorProximityEntry();
+		FreeEntries.Add(Index);
+	}
+}
+
+void UDoorProximitySubsystem::UpdateDoor(ADoor* Door)
+{
+	const int32* Index = DoorEntries.Find(Door);
+	if (!Index)
+	{
+		return;
+	}
+
+	RemoveFromCells(*Index);
+
+	FDoorProximityEntry& Entry = Entries[*Index];
+	Entry.Transform = FTransform(Door->GetActorQuat(), Door->GetDoorSidePlane().Location);
+	Entry.Extent = Door->AutoDoorTriggerExtent.ComponentMax(FVector::ZeroVector);
+	Entry.Hysteresis = FMath::Max<float>(Door->AutoDoorHysteresis, 0.f);
+
+	AddToCells(*Index);
+}
+
+bool UDoorProximitySubsystem::IsAutoDoorOccupied(const ADoor* Door) const
+{
+	const int32* Index = DoorEntries.Find(Door);
+	return Index && Entries[*Index].bOccupied;
+}
+
+bool UDoorProximitySubsystem::IsAutoDoorPredicting(const ADoor* Door) const
+{
+	const int32* Index = DoorEntries.Find(Door);
+	return Index && Entries[*Index].PredictedOpenTime >= 0.f;
+}
+
+void UDoorProximitySubsystem::AddToCells(int32 Index)
+{
+	FDoorProximityEntry& Entry = Entries[Index];
+	const FBox Bounds = FBox(-Entry.Extent - Entry.Hysteresis, Entry.Extent + Entry.Hysteresis).TransformBy(Entry.Transform);
+	const FIntPoint Min = GetCell(Bounds.Min);
+	const FIntPoint Max = GetCell(Bounds.Max);
+	for (int32 X = Min.X; X <= Max.X; X++)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+		{
+			Entry.Cells.Add({ X, Y });
+			Cells.FindOrAdd({ X, Y }).Add(Index);
+		}
+	}
+}
+
+void UDoorProximitySubsystem::RemoveFromCells(int32 Index)
+{
+	FDoorProximityEntry& Entry = Entries[Index];
+	for (const FIntPoint& CellKey : Entry.Cells)
+	{
+		if (TArray<int32, TInlineAllocator<4>>* Cell = Cells.Find(CellKey))
+		{
+			Cell->RemoveSingleSwap(Index, EAllowShrinking::No);
+			if (Cell->IsEmpty())
+			{
+				Cells.Remove(CellKey);
+			}
+		}
+	}
+	Entry.Cells.Reset();
+}
+
+void UDoorProximitySubsystem::OnActorSpawned(AActor* Actor)
+{
+	if (APawn* Pawn = Cast<APawn>(Actor))
+	{
+		Pawns.Add(Pawn);
+	}
+}
+
+void UDoorProximitySubsystem::UpdateProximity(float TimeSeconds)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDoorProximitySubsystem::UpdateProximity);
+
+	Pawns.RemoveAllSwap([](const TWeakObjectPtr<APawn>& Pawn) { return !Pawn.IsValid(); });
+
+	// Clients only predict for their own pawns, other pawns open the door via the server
+	const bool bClient = GetWorld()->GetNetMode() == NM_Client;
+
+	// The first pawn found inside each door's trigger, indexed by entry
+	TArray<APawn*, TInlineAllocator<64>> OccupyingPawns;
+	OccupyingPawns.SetNumZeroed(Entries.Num());
+
+	for (const TWeakObjectPtr<APawn>& WeakPawn : Pawns)
+	{
+		APawn* Pawn = WeakPawn.Get();
+		if (bClient && !Pawn->IsLocallyControlled())
+		{
+			continue;
+		}
+		
+		const FVector PawnLocation = Pawn->GetActorLocation();
+		const TArray<int32, TInlineAllocator<4>>* Cell = Cells.Find(GetCell(PawnLocation));
+		if (!Cell)
+		{
+			continue;
+		}
+
+		for (const int32 Index : *Cell)
+		{
+			if (OccupyingPawns[Index])
+			{
+				continue;
+			}
+			
+			// Occupied doors use the larger extent so pawns at the edge don't flicker the door
+			const FDoorProximityEntry& Entry = Entries[Index];
+			const FVector Extent = Entry.bOccupied ? Entry.Extent + Entry.Hysteresis : Entry.Extent;
+			const FVector Local = Entry.Transform.InverseTransformPositionNoScale(PawnLocation);
+			if (FMath::Abs(Local.X) <= Extent.X && FMath::Abs(Local.Y) <= Extent.Y && FMath::Abs(Local.Z) <= Extent.Z &&
+				Entry.Door->CanPawnTriggerAutoDoor(Pawn))
+			{
+				OccupyingPawns[Index] = Pawn;
+			}
+		}
+	}
+
+	for (int32 Index = 0; Index < Entries.Num(); Index++)
+	{
+		FDoorProximityEntry& Entry = Entries[Index];
+		if (Entry.bValid && Entry.Door.IsValid())
+		{
+			if (bClient)
+			{
+				UpdatePredictedAutoDoor(Entry, OccupyingPawns[Index], TimeSeconds);
+			}
+			else
+			{
+				UpdateAutoDoor(Entry, OccupyingPawns[Index], TimeSeconds);
+			}
+		}
+	}
+}
+
+void UDoorProximitySubsystem::UpdateAutoDoor(FDoorProximityEntry& Entry, APawn* OccupyingPawn, float TimeSeconds)
+{
+	ADoor* Door = Entry.Door.Get();
+	
+	Entry.bOccupied = OccupyingPawn != nullptr;
+	if (Entry.bOccupied)
+	{
+		Entry.LastOccupiedTime = TimeSeconds;
+	}
+
+	EDoorState NewDoorState;
+	EDoorDirection NewDoorDirection;
+	EDoorMotion DoorMotion;
+	FGameplayTag FailReason;
+	
+	if (Entry.bOccupied && Door->IsDoorClosedOrClosing())
+	{
+		// Open away from the pawn
+		const FDoorSidePlane& Plane = Door->GetDoorSidePlane();
+		const EDoorSide Side = UDoorStatics::GetDoorSideFromLocation(OccupyingPawn->GetActorLocation(), Plane.Location, Plane.Forward);
+		if (UDoorStatics::ProgressDoorState(Door, Door->GetDoorState(), Door->GetDoorDirection(), Side,
+			NewDoorState, NewDoorDirection, DoorMotion, FailReason))
+		{
+			Door->SetDoorState(NewDoorState, NewDoorDirection, OccupyingPawn);
+		}
+	}
+	else if (!Entry.bOccupied && Door->IsDoorOpenOrOpening() && TimeSeconds - Entry.LastOccupiedTime >= Door->AutoDoorHoldOpenTime)
+	{
+		// Agents are still waiting at the door to pass through
+		const UDoorTraversalSubsystem* TraversalSubsystem = GetWorld()->GetSubsystem<UDoorTraversalSubsystem>();
+		if (TraversalSubsystem && TraversalSubsystem->IsDoorHeldOpen(Door))
+		{
+			return;
+		}
+
+		// The side only affects the motion when closing
+		if (UDoorStatics::ProgressDoorState(Door, Door->GetDoorState(), Door->GetDoorDirection(), EDoorSide::Front,
+			NewDoorState, NewDoorDirection, DoorMotion, FailReason))
+		{
+			Door->SetDoorState(NewDoorState, NewDoorDirection, nullptr);
+		}
+	}
+}
+
+void UDoorProximitySubsystem::UpdatePredictedAutoDoor(FDoorProximityEntry& Entry, APawn* OccupyingPawn, float TimeSeconds)
+{
+	ADoor* Door = Entry.Door.Get();
+
+	// Nothing replicates to acknowledge or correct us, so there is no prediction, run the door the way the server does
+	if (!Door->IsDoorStateReplicationEnabled())
+	{
+		Entry.PredictedOpenTime = -1.f;
+		UpdateAutoDoor(Entry, OccupyingPawn, TimeSeconds);
+		return;
+	}
+
+	Entry.bOccupied = OccupyingPawn != nullptr;
+	if (Entry.bOccupied)
+	{
+		Entry.LastOccupiedTime = TimeSeconds;
+	}
+
+	if (Entry.PredictedOpenTime >= 0.f)
+	{
+		EDoorState RepDoorState;
+		EDoorDirection RepDoorDirection;
+		Door->GetRepDoorState(RepDoorState, RepDoorDirection);
+		
+		if (Door->IsDoorStateOpenOrOpening(RepDoorState))
+		{
+			// The server agrees, its replicated state is applied as normal from here on, including closing
+			Entry.PredictedOpenTime = -1.f;
+		}
+		else if (TimeSeconds - Entry.PredictedOpenTime >= DoorProximityCVars::PredictionTimeout)
+		{
+			// The server didn't open the door for us, e.g. it was locked or our pawn was rejected
+			Entry.PredictedOpenTime = -1.f;
+			Door->ReconcileAutoDoorPrediction();
+		}
+		return;
+	}
+
+	// Closing is left to the server, it knows about every pawn in the trigger
+	if (!Entry.bOccupied || !Door->IsDoorClosedOrClosing())
+	{
+		return;
+	}
+
+	EDoorState NewDoorState;
+	EDoorDirection NewDoorDirection;
+	EDoorMotion DoorMotion;
+	FGameplayTag FailReason;
+
+	// Open away from the pawn, the server resolves the same side from the same trigger
+	const FDoorSidePlane& Plane = Door->GetDoorSidePlane();
+	const EDoorSide Side = UDoorStatics::GetDoorSideFromLocation(OccupyingPawn->GetActorLocation(), Plane.Location, Plane.Forward);
+	if (UDoorStatics::ProgressDoorState(Door, Door->GetDoorState(), Door->GetDoorDirection(), Side,
+		NewDoorState, NewDoorDirection, DoorMotion, FailReason))
+	{
+		// Not routed through the interaction prediction, that would hold every replicated state until acknowledged
+		Door->SetDoorState(NewDoorState, NewDoorDirection, nullptr);
+		Entry.PredictedOpenTime = TimeSeconds;
+	}
+}
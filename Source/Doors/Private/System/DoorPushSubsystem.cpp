@@ -0,0 +1,195 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "System/DoorPushSubsystem.h"
+
+#include "Door.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PawnMovementComponent.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DoorPushSubsystem)
+
+namespace DoorPushCVars
+{
+	static bool bPushEnabled = true;
+	static FAutoConsoleVariableRef CVarPushEnabled(
+		TEXT("p.Door.Push.Enabled"),
+		bPushEnabled,
+		TEXT("If true, moving doors with bPushPawns push pawns out of the way of their leaf.\n"),
+		ECVF_Default);
+}
+
+bool UDoorPushSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDoorPushSubsystem::Deinitialize()
+{
+	Entries.Empty();
+	FreeEntries.Empty();
+	DoorEntries.Empty();
+
+	Super::Deinitialize();
+}
+
+void UDoorPushSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	ConsumeQueries();
+	IssueQueries();
+}
+
+TStatId UDoorPushSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDoorPushSubsystem, STATGROUP_Tickables);
+}
+
+bool UDoorPushSubsystem::IsTickable() const
+{
+	return DoorPushCVars::bPushEnabled && !DoorEntries.IsEmpty();
+}
+
+void UDoorPushSubsystem::RegisterDoor(ADoor* Door)
+{
+	if (!IsValid(Door) || DoorEntries.Contains(Door))
+	{
+		return;
+	}
+
+	const int32 Index = FreeEntries.Num() > 0 ? FreeEntries.Pop(EAllowShrinking::No) : Entries.AddDefaulted();
+	Entries[Index].Door = Door;
+	Entries[Index].DoorKey = Door;
+	Entries[Index].bValid = true;
+	DoorEntries.Add(Door, Index);
+}
+
+void UDoorPushSubsystem::UnregisterDoor(ADoor* Door)
+{
+	int32 Index;
+	if (DoorEntries.RemoveAndCopyValue(Door, Index))
+	{
+		Entries[Index] = FDoorPushEntry();
+		FreeEntries.Add(Index);
+	}
+}
+
+void UDoorPushSubsystem::ConsumeQueries()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDoorPushSubsystem::ConsumeQueries);
+
+	UWorld* World = GetWorld();
+	for (FDoorPushEntry& Entry : Entries)
+	{
+		if (!Entry.bValid || !Entry.PendingQuery.IsValid())
+		{
+			continue;
+		}
+
+		// Overlaps run at the end of the frame they were issued, so they're always ready by now
+		FOverlapDatum Datum;
+		const bool bHasData = World->QueryOverlapData(Entry.PendingQuery, Datum);
+		Entry.PendingQuery = FTraceHandle();
+
+		ADoor* Door = Entry.Door.Get();
+		UPrimitiveComponent* Leaf = Door ? Door->GetDoorLeaf() : nullptr;
+		if (!bHasData || !Leaf)
+		{
+			continue;
+		}
+
+		ScratchPawns.Reset();
+		for (const FOverlapResult& Overlap : Datum.OutOverlaps)
+		{
+			// Moving a remote player's pawn on the server would fight its client's prediction
+			APawn* Pawn = Cast<APawn>(Overlap.GetActor());
+			if (IsValid(Pawn) && (Pawn->IsLocallyControlled() ||
+				(Pawn->GetLocalRole() == ROLE_Authority && Pawn->GetRemoteRole() != ROLE_AutonomousProxy)))
+			{
+				ScratchPawns.AddUnique(Pawn);
+			}
+		}
+
+		// Only doors with pawns in their path pay for depenetration
+		if (!ScratchPawns.IsEmpty())
+		{
+			ResolvePush(Door, Leaf, ScratchPawns);
+		}
+	}
+}
+
+void UDoorPushSubsystem::IssueQueries()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDoorPushSubsystem::IssueQueries);
+
+	UWorld* World = GetWorld();
+	for (int32 Index = 0; Index < Entries.Num(); Index++)
+	{
+		FDoorPushEntry& Entry = Entries[Index];
+		if (!Entry.bValid)
+		{
+			continue;
+		}
+
+		// Stationary doors can't push anything, they register again when they start moving
+		ADoor* Door = Entry.Door.Get();
+		UPrimitiveComponent* Leaf = Door ? Door->GetDoorLeaf() : nullptr;
+		if (!Door || !Leaf || !Door->IsDoorInMotion())
+		{
+			DoorEntries.Remove(Entry.DoorKey);
+			Entry = FDoorPushEntry();
+			FreeEntries.Add(Index);
+			continue;
+		}
+
+		// Cover the leaf's motion since the last query
+		const FBox LeafBounds = Leaf->Bounds.GetBox();
+		const FBox SweptBounds = Entry.LastLeafBounds.IsValid ? Entry.LastLeafBounds + LeafBounds : LeafBounds;
+		Entry.LastLeafBounds = LeafBounds;
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(DoorPush), false, Door);
+		Entry.PendingQuery = World->AsyncOverlapByObjectType(SweptBounds.GetCenter(), FQuat::Identity,
+			FCollisionObjectQueryParams(ECC_Pawn), FCollisionShape::MakeBox(SweptBounds.GetExtent()), QueryParams);
+	}
+}
+
+void UDoorPushSubsystem::ResolvePush(ADoor* Door, UPrimitiveComponent* Leaf, const TArray<APawn*>& Pawns) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDoorPushSubsystem::ResolvePush);
+
+	for (APawn* Pawn : Pawns)
+	{
+		UPrimitiveComponent* PawnPrimitive = Cast<UPrimitiveComponent>(Pawn->GetRootComponent());
+		if (!PawnPrimitive)
+		{
+			continue;
+		}
+
+		// The swept volume is conservative, the pawn may not be touching the leaf at all
+		const FVector PawnLocation = PawnPrimitive->GetComponentLocation();
+		const FQuat PawnRotation = PawnPrimitive->GetComponentQuat();
+		FMTDResult MTD;
+		if (!Leaf->ComputePenetration(MTD, PawnPrimitive->GetCollisionShape(), PawnLocation, PawnRotation) || MTD.Distance <= 0.f)
+		{
+			continue;
+		}
+
+		UE_LOG(LogDoors, VeryVerbose, TEXT("UDoorPushSubsystem::ResolvePush: %s pushing %s by %f"), *GetNameSafe(Door),
+			*GetNameSafe(Pawn), MTD.Distance);
+
+		// Let the movement component resolve it, it knows how to slide out without penetrating anything else
+		if (UPawnMovementComponent* Movement = Pawn->GetMovementComponent())
+		{
+			FHitResult Hit(Door, Leaf, PawnLocation, MTD.Direction);
+			Hit.bStartPenetrating = true;
+			Hit.PenetrationDepth = MTD.Distance;
+			Movement->ResolvePenetration(Movement->GetPenetrationAdjustment(Hit), Hit, PawnRotation);
+		}
+		else
+		{
+			Pawn->AddActorWorldOffset(MTD.Direction * MTD.Distance, false, nullptr, ETeleportType::TeleportPhysics);
+		}
+	}
+}
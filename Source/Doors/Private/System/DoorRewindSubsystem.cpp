@@ -0,0 +1,258 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "System/DoorRewindSubsystem.h"
+
+#include "Door.h"
+#include "DoorStatics.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DoorRewindSubsystem)
+
+namespace DoorRewindCVars
+{
+	static bool bRewindEnabled = true;
+	static FAutoConsoleVariableRef CVarRewindEnabled(
+		TEXT("p.Door.Rewind.Enabled"),
+		bRewindEnabled,
+		TEXT("If true, the server rewinds avatars and doors to the client's timestamp when validating an untrusted client door side.\n"),
+		ECVF_Default);
+
+	static float SampleRate = 30.f;
+	static FAutoConsoleVariableRef CVarSampleRate(
+		TEXT("p.Door.Rewind.SampleRate"),
+		SampleRate,
+		TEXT("How many times per second avatar and door locations are recorded for rewinding. Clamped so that the history covers p.Door.Rewind.MaxRewindTime.\n"),
+		ECVF_Default);
+
+	static float MaxRewindTime = 0.5f;
+	static FAutoConsoleVariableRef CVarMaxRewindTime(
+		TEXT("p.Door.Rewind.MaxRewindTime"),
+		MaxRewindTime,
+		TEXT("Maximum time in seconds the server will rewind when validating the client's door side.\n"),
+		ECVF_Default);
+
+	/**
+	 * The history holds a fixed number of samples, sampling faster than it can cover MaxRewindTime would drop the
+	 * samples we need to rewind that far
+	 */
+	static float GetSampleInterval()
+	{
+		const float MaxSampleRate = (DoorRewindMaxSamples - 1) / FMath::Max<float>(MaxRewindTime, UE_KINDA_SMALL_NUMBER);
+		return 1.f / FMath::Clamp<float>(SampleRate, 1.f, FMath::Max<float>(MaxSampleRate, 1.f));
+	}
+}
+
+bool UDoorRewindSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDoorRewindSubsystem::Deinitialize()
+{
+	AvatarHistory.Empty();
+	DoorHistory.Empty();
+	TrackedAvatars.Empty();
+
+	Super::Deinitialize();
+}
+
+void UDoorRewindSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+	const float SampleInterval = DoorRewindCVars::GetSampleInterval();
+	if (LastSampleTime >= 0.f && TimeSeconds - LastSampleTime < SampleInterval)
+	{
+		return;
+	}
+
+	LastSampleTime = TimeSeconds;
+	RecordSamples(TimeSeconds);
+}
+
+TStatId UDoorRewindSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDoorRewindSubsystem, STATGROUP_Tickables);
+}
+
+bool UDoorRewindSubsystem::IsTickable() const
+{
+	// Only the server validates the client's door side, and there is no latency to compensate for in standalone
+	const UWorld* World = GetWorld();
+	return DoorRewindCVars::bRewindEnabled && World && (World->GetNetMode() == NM_DedicatedServer || World->GetNetMode() == NM_ListenServer);
+}
+
+void UDoorRewindSubsystem::TrackAvatar(const AActor* Avatar)
+{
+	if (IsValid(Avatar))
+	{
+		TrackedAvatars.AddUnique(Avatar);
+	}
+}
+
+void UDoorRewindSubsystem::UntrackAvatar(const AActor* Avatar)
+{
+	TrackedAvatars.Remove(Avatar);
+	AvatarHistory.Remove(Avatar);
+}
+
+void UDoorRewindSubsystem::RegisterDoor(const ADoor* Door)
+{
+	if (IsValid(Door))
+	{
+		DoorHistory.FindOrAdd(Door);
+	}
+}
+
+void UDoorRewindSubsystem::UnregisterDoor(const ADoor* Door)
+{
+	DoorHistory.Remove(Door);
+}
+
+void UDoorRewindSubsystem::RecordSamples(float TimeSeconds)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDoorRewindSubsystem::RecordSamples);
+
+	// Remove history for avatars and doors that no longer exist
+	for (auto It = AvatarHistory.CreateIterator(); It; ++It)
+	{
+		if (!It->Key.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+	for (auto It = DoorHistory.CreateIterator(); It; ++It)
+	{
+		if (!It->Key.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+	TrackedAvatars.RemoveAllSwap([](const TWeakObjectPtr<const AActor>& Avatar) { return !Avatar.IsValid(); });
+
+	const auto RecordAvatar = [this, TimeSeconds](const AActor* Avatar)
+	{
+		AvatarHistory.FindOrAdd(Avatar).Add({ TimeSeconds, Avatar->GetActorLocation() });
+	};
+
+	// Player pawns are tracked automatically
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+		if (const APawn* Pawn = PC ? PC->GetPawn() : nullptr)
+		{
+			RecordAvatar(Pawn);
+		}
+	}
+
+	for (const TWeakObjectPtr<const AActor>& Avatar : TrackedAvatars)
+	{
+		RecordAvatar(Avatar.Get());
+	}
+
+	// Doors only record a sample when their transform changes, stationary doors have a single sample
+	for (auto& DoorPair : DoorHistory)
+	{
+		const ADoor* Door = DoorPair.Key.Get();
+		TDoorRewindHistory<FDoorRewindDoorSample>& History = DoorPair.Value;
+
+		const FDoorSidePlane& Plane = Door->GetDoorSidePlane();
+		const FVector& Location = Plane.Location;
+		const FVector& Forward = Plane.Forward;
+		if (!History.IsEmpty())
+		{
+			const FDoorRewindDoorSample& Newest = History.GetFromNewest(0);
+			if (Newest.Location.Equals(Location) && Newest.Forward.Equals(Forward))
+			{
+				continue;
+			}
+		}
+		History.Add({ TimeSeconds, Location, Forward });
+	}
+}
+
+bool UDoorRewindSubsystem::GetAvatarLocationAtTime(const AActor* Avatar, float Timestamp, FVector& OutLocation) const
+{
+	const TDoorRewindHistory<FDoorRewindAvatarSample>* History = AvatarHistory.Find(Avatar);
+	if (!History || History->IsEmpty())
+	{
+		return false;
+	}
+
+	// Treat the current location as the newest sample
+	FDoorRewindAvatarSample Newer = { GetWorld()->GetTimeSeconds(), Avatar->GetActorLocation() };
+	for (int32 i = 0; i < History->Num; i++)
+	{
+		const FDoorRewindAvatarSample& Older = History->GetFromNewest(i);
+		if (Older.Time <= Timestamp)
+		{
+			const float Range = Newer.Time - Older.Time;
+			const float Alpha = Range > UE_KINDA_SMALL_NUMBER ? (Timestamp - Older.Time) / Range : 1.f;
+			OutLocation = FMath::Lerp(Older.Location, Newer.Location, FMath::Clamp<float>(Alpha, 0.f, 1.f));
+			return true;
+		}
+		Newer = Older;
+	}
+
+	// Older than our history, use the oldest sample
+	OutLocation = Newer.Location;
+	return true;
+}
+
+bool UDoorRewindSubsystem::GetDoorSampleAtTime(const ADoor* Door, float Timestamp, FDoorRewindDoorSample& OutSample) const
+{
+	const TDoorRewindHistory<FDoorRewindDoorSample>* History = DoorHistory.Find(Door);
+	if (!History || History->IsEmpty())
+	{
+		return false;
+	}
+
+	// Samples are only recorded on change, so the first sample at or before the timestamp is the door's transform
+	for (int32 i = 0; i < History->Num; i++)
+	{
+		const FDoorRewindDoorSample& Sample = History->GetFromNewest(i);
+		if (Sample.Time <= Timestamp)
+		{
+			OutSample = Sample;
+			return true;
+		}
+	}
+
+	// Older than our history, use the oldest sample
+	OutSample = History->GetFromNewest(History->Num - 1);
+	return true;
+}
+
+EDoorSide UDoorRewindSubsystem::GetDoorSideAtTime(const AActor* Avatar, const ADoor* Door, float Timestamp) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDoorRewindSubsystem::GetDoorSideAtTime);
+
+	if (!IsValid(Avatar) || !IsValid(Door))
+	{
+		return EDoorSide::Front;
+	}
+
+	// Never rewind further than allowed, this also rejects timestamps from the future
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+	Timestamp = FMath::Clamp<float>(Timestamp, TimeSeconds - DoorRewindCVars::MaxRewindTime, TimeSeconds);
+
+	FVector AvatarLocation;
+	if (!GetAvatarLocationAtTime(Avatar, Timestamp, AvatarLocation))
+	{
+		AvatarLocation = Avatar->GetActorLocation();
+	}
+
+	FDoorRewindDoorSample DoorSample;
+	if (!GetDoorSampleAtTime(Door, Timestamp, DoorSample))
+	{
+		const FDoorSidePlane& Plane = Door->GetDoorSidePlane();
+		DoorSample.Location = Plane.Location;
+		DoorSample.Forward = Plane.Forward;
+	}
+
+	return UDoorStatics::GetDoorSideFromLocation(AvatarLocation, DoorSample.Location, DoorSample.Forward);
+}
@@ -0,0 +1,262 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "System/DoorSpatialSubsystem.h"
+
+#include "Door.h"
+#include "ConvexVolume.h"
+#include "Engine/World.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DoorSpatialSubsystem)
+
+namespace DoorSpatialCVars
+{
+	static float CellSize = 1000.f;
+	static FAutoConsoleVariableRef CVarCellSize(
+		TEXT("p.Door.Spatial.CellSize"),
+		CellSize,
+		TEXT("Size of each cell in the door spatial index, applies to worlds created after it changes.\n"),
+		ECVF_Default);
+
+	static float DoorRadius = 100.f;
+	static FAutoConsoleVariableRef CVarDoorRadius(
+		TEXT("p.Door.Spatial.DoorRadius"),
+		DoorRadius,
+		TEXT("Radius of the sphere used to test doors against a frustum.\n"),
+		ECVF_Default);
+}
+
+// -------------------------------------------------------------
+// FDoorSpatialIndex
+
+int32 FDoorSpatialIndex::Add(ADoor* Door, const FVector& Location, EDoorState DoorState, EDoorDirection DoorDirection)
+{
+	const int32 Index = FreeEntries.Num() > 0 ? FreeEntries.Pop(EAllowShrinking::No) : Entries.AddDefaulted();
+	
+	FDoorSpatialEntry& Entry = Entries[Index];
+	Entry.Door = Door;
+	Entry.Location = Location;
+	Entry.Cell = GetCell(Location);
+	Entry.DoorState = DoorState;
+	Entry.DoorDirection = DoorDirection;
+	Entry.bValid = true;
+	
+	Cells.FindOrAdd(Entry.Cell).Add(Index);
+	return Index;
+}
+
+void FDoorSpatialIndex::Remove(int32 Index)
+{
+	if (!Entries.IsValidIndex(Index) || !Entries[Index].bValid)
+	{
+		return;
+	}
+
+	FDoorSpatialEntry& Entry = Entries[Index];
+	if (TArray<int32, TInlineAllocator<8>>* Cell = Cells.Find(Entry.Cell))
+	{
+		Cell->RemoveSingleSwap(Index, EAllowShrinking::No);
+		if (Cell->IsEmpty())
+		{
+			Cells.Remove(Entry.Cell);
+		}
+	}
+
+	Entry = FDoorSpatialEntry();
+	FreeEntries.Add(Index);
+}
+
+void FDoorSpatialIndex::Update(int32 Index, const FVector& Location, EDoorState DoorState, EDoorDirection DoorDirection)
+{
+	if (!Entries.IsValidIndex(Index) || !Entries[Index].bValid)
+	{
+		return;
+	}
+
+	FDoorSpatialEntry& Entry = Entries[Index];
+	Entry.Location = Location;
+	Entry.DoorState = DoorState;
+	Entry.DoorDirection = DoorDirection;
+
+	// Only touch the cells if we moved to a different cell
+	const FIntPoint NewCell = GetCell(Location);
+	if (NewCell != Entry.Cell)
+	{
+		if (TArray<int32, TInlineAllocator<8>>* Cell = Cells.Find(Entry.Cell))
+		{
+			Cell->RemoveSingleSwap(Index, EAllowShrinking::No);
+			if (Cell->IsEmpty())
+			{
+				Cells.Remove(Entry.Cell);
+			}
+		}
+		Entry.Cell = NewCell;
+		Cells.FindOrAdd(NewCell).Add(Index);
+	}
+}
+
+int32 FDoorSpatialIndex::QueryRadius(const FVector& Origin, float Radius, TArray<int32>& OutIndices, uint8 StateMask) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FDoorSpatialIndex::QueryRadius);
+	
+	OutIndices.Reset();
+	ForEachInRadius(Origin, Radius, StateMask, [&OutIndices](const FDoorSpatialEntry&, int32 Index, double)
+	{
+		OutIndices.Add(Index);
+	});
+	return OutIndices.Num();
+}
+
+int32 FDoorSpatialIndex::QueryNearest(const FVector& Origin, int32 K, float MaxRadius, TArray<int32>& OutIndices,
+	uint8 StateMask) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FDoorSpatialIndex::QueryNearest);
+	
+	OutIndices.Reset();
+	if (K <= 0)
+	{
+		return 0;
+	}
+
+	// Keep the K nearest in a max-heap so the furthest is replaced first
+	TArray<TPair<double, int32>, TInlineAllocator<32>> Nearest;
+	const auto FurthestFirst = [](const TPair<double, int32>& A, const TPair<double, int32>& B) { return A.Key > B.Key; };
+	ForEachInRadius(Origin, MaxRadius, StateMask, [&](const FDoorSpatialEntry&, int32 Index, double DistSquared)
+	{
+		if (Nearest.Num() < K)
+		{
+			Nearest.HeapPush({ DistSquared, Index }, FurthestFirst);
+		}
+		else if (DistSquared < Nearest.HeapTop().Key)
+		{
+			Nearest.HeapPopDiscard(FurthestFirst, EAllowShrinking::No);
+			Nearest.HeapPush({ DistSquared, Index }, FurthestFirst);
+		}
+	});
+
+	Nearest.Sort([](const TPair<double, int32>& A, const TPair<double, int32>& B) { return A.Key < B.Key; });
+	for (const TPair<double, int32>& Pair : Nearest)
+	{
+		OutIndices.Add(Pair.Value);
+	}
+	return OutIndices.Num();
+}
+
+int32 FDoorSpatialIndex::QueryFrustum(const FConvexVolume& Frustum, const FVector& Origin, float MaxDistance,
+	TArray<int32>& OutIndices, uint8 StateMask) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FDoorSpatialIndex::QueryFrustum);
+	
+	OutIndices.Reset();
+	const float DoorRadius = DoorSpatialCVars::DoorRadius;
+	ForEachInRadius(Origin, MaxDistance, StateMask, [&](const FDoorSpatialEntry& Entry, int32 Index, double)
+	{
+		if (Frustum.IntersectSphere(Entry.Location, DoorRadius))
+		{
+			OutIndices.Add(Index);
+		}
+	});
+	return OutIndices.Num();
+}
+
+// -------------------------------------------------------------
+// UDoorSpatialSubsystem
+
+bool UDoorSpatialSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDoorSpatialSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	
+	Index = FDoorSpatialIndex(DoorSpatialCVars::CellSize);
+}
+
+void UDoorSpatialSubsystem::Deinitialize()
+{
+	Index = FDoorSpatialIndex();
+	DoorIndices.Empty();
+	Snapshot.Reset();
+	
+	Super::Deinitialize();
+}
+
+void UDoorSpatialSubsystem::RegisterDoor(ADoor* Door)
+{
+	if (!IsValid(Door) || DoorIndices.Contains(Door))
+	{
+		return;
+	}
+	
+	DoorIndices.Add(Door, Index.Add(Door, Door->GetDoorLocation(), Door->GetDoorState(), Door->GetDoorDirection()));
+	bSnapshotDirty = true;
+}
+
+void UDoorSpatialSubsystem::UnregisterDoor(ADoor* Door)
+{
+	int32 EntryIndex;
+	if (DoorIndices.RemoveAndCopyValue(Door, EntryIndex))
+	{
+		Index.Remove(EntryIndex);
+		bSnapshotDirty = true;
+	}
+}
+
+void UDoorSpatialSubsystem::UpdateDoor(ADoor* Door)
+{
+	if (const int32* EntryIndex = IsValid(Door) ? DoorIndices.Find(Door) : nullptr)
+	{
+		Index.Update(*EntryIndex, Door->GetDoorLocation(), Door->GetDoorState(), Door->GetDoorDirection());
+		bSnapshotDirty = true;
+	}
+}
+
+TSharedRef<const FDoorSpatialIndex, ESPMode::ThreadSafe> UDoorSpatialSubsystem::GetSnapshot() const
+{
+	check(IsInGameThread());
+	
+	if (bSnapshotDirty || !Snapshot.IsValid())
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(UDoorSpatialSubsystem::GetSnapshot);
+		
+		// Workers holding the previous snapshot keep it alive until they're done
+		Snapshot = MakeShared<const FDoorSpatialIndex, ESPMode::ThreadSafe>(Index);
+		bSnapshotDirty = false;
+	}
+	return Snapshot.ToSharedRef();
+}
+
+int32 UDoorSpatialSubsystem::QueryRadius(const FVector& Origin, float Radius, TArray<ADoor*>& OutDoors, uint8 StateMask) const
+{
+	Index.QueryRadius(Origin, Radius, ScratchIndices, StateMask);
+	return ResolveDoors(ScratchIndices, OutDoors);
+}
+
+int32 UDoorSpatialSubsystem::QueryNearest(const FVector& Origin, int32 K, float MaxRadius, TArray<ADoor*>& OutDoors,
+	uint8 StateMask) const
+{
+	Index.QueryNearest(Origin, K, MaxRadius, ScratchIndices, StateMask);
+	return ResolveDoors(ScratchIndices, OutDoors);
+}
+
+int32 UDoorSpatialSubsystem::QueryFrustum(const FConvexVolume& Frustum, const FVector& Origin, float MaxDistance,
+	TArray<ADoor*>& OutDoors, uint8 StateMask) const
+{
+	Index.QueryFrustum(Frustum, Origin, MaxDistance, ScratchIndices, StateMask);
+	return ResolveDoors(ScratchIndices, OutDoors);
+}
+
+int32 UDoorSpatialSubsystem::ResolveDoors(const TArray<int32>& Indices, TArray<ADoor*>& OutDoors) const
+{
+	OutDoors.Reset();
+	for (const int32 EntryIndex : Indices)
+	{
+		if (ADoor* Door = Index.Entries[EntryIndex].Door.Get())
+		{
+			OutDoors.Add(Door);
+		}
+	}
+	return OutDoors.Num();
+}
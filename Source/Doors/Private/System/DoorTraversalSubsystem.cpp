@@ -0,0 +1,355 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "System/DoorTraversalSubsystem.h"
+
+#include "Door.h"
+#include "DoorStatics.h"
+#include "Engine/World.h"
+#include "Navigation/PathFollowingComponent.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(DoorTraversalSubsystem)
+
+namespace DoorTraversalCVars
+{
+	static float DecisionRate = 10.f;
+	static FAutoConsoleVariableRef CVarDecisionRate(
+		TEXT("p.Door.Traversal.DecisionRate"),
+		DecisionRate,
+		TEXT("How many times per second each door decides whether to open for the agents queued to pass through it.\n"),
+		ECVF_Default);
+
+	static float MaxWaitTime = 10.f;
+	static FAutoConsoleVariableRef CVarMaxWaitTime(
+		TEXT("p.Door.Traversal.MaxWaitTime"),
+		MaxWaitTime,
+		TEXT("Agents that have not passed through the door after this many seconds are removed from its queue.\n"),
+		ECVF_Default);
+
+	static float CloseDelay = 1.f;
+	static FAutoConsoleVariableRef CVarCloseDelay(
+		TEXT("p.Door.Traversal.CloseDelay"),
+		CloseDelay,
+		TEXT("Seconds after the last agent passes through before closing a door that was opened for traversal. Negative to leave the door open.\n"),
+		ECVF_Default);
+}
+
+bool UDoorTraversalSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDoorTraversalSubsystem::Deinitialize()
+{
+	for (auto& It : DoorQueues)
+	{
+		for (FDoorTraversalAgent& Queued : It.Value.Agents)
+		{
+			if (UPathFollowingComponent* PathFollowing = Queued.PathFollowing.Get())
+			{
+				PathFollowing->OnRequestFinished.Remove(Queued.MoveFinishedHandle);
+			}
+		}
+	}
+	DoorQueues.Empty();
+
+	Super::Deinitialize();
+}
+
+void UDoorTraversalSubsystem::Tick(float DeltaTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDoorTraversalSubsystem::Tick);
+	
+	Super::Tick(DeltaTime);
+
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+	const float DecisionInterval = 1.f / FMath::Max<float>(DoorTraversalCVars::DecisionRate, 1.f);
+	if (LastDecisionTime >= 0.f && TimeSeconds - LastDecisionTime < DecisionInterval)
+	{
+		return;
+	}
+	LastDecisionTime = TimeSeconds;
+
+	// Path following may call back into the subsystem, so agents are resumed and released after iterating the queues
+	TArray<FDoorTraversalAgent> ReleasedAgents;
+	TArray<TWeakObjectPtr<UPathFollowingComponent>, TInlineAllocator<8>> ResumedMoves;
+
+	for (auto It = DoorQueues.CreateIterator(); It; ++It)
+	{
+		ADoor* Door = It->Key.Get();
+		FDoorTraversalQueue& Queue = It->Value;
+		if (!IsValid(Door))
+		{
+			// The door is gone, let the agents find another path
+			ReleasedAgents.Append(Queue.Agents);
+			It.RemoveCurrent();
+			continue;
+		}
+
+		UpdateQueue(Door, Queue, TimeSeconds, ReleasedAgents);
+		DecideForQueue(Door, Queue, TimeSeconds);
+
+		// Let the agents through once the door is open
+		if (Door->GetDoorState() == EDoorState::Open)
+		{
+			for (FDoorTraversalAgent& Queued : Queue.Agents)
+			{
+				if (Queued.bPaused)
+				{
+					Queued.bPaused = false;
+					ResumedMoves.Add(Queued.PathFollowing);
+				}
+			}
+		}
+
+		// Nothing left to do for this door
+		if (Queue.Agents.IsEmpty() && !Queue.bOpenedForTraversal)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (const TWeakObjectPtr<UPathFollowingComponent>& PathFollowing : ResumedMoves)
+	{
+		if (PathFollowing.IsValid())
+		{
+			PathFollowing->ResumeMove();
+		}
+	}
+
+	// Agents that leave the queue while paused never saw the door open, abort so they find another path
+	for (FDoorTraversalAgent& Queued : ReleasedAgents)
+	{
+		ReleaseAgent(Queued, false);
+	}
+}
+
+TStatId UDoorTraversalSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDoorTraversalSubsystem, STATGROUP_Tickables);
+}
+
+bool UDoorTraversalSubsystem::IsTickable() const
+{
+	const UWorld* World = GetWorld();
+	return !DoorQueues.IsEmpty() && World && World->GetNetMode() != NM_Client;
+}
+
+void UDoorTraversalSubsystem::EnqueueAgent(AActor* Agent, ADoor* Door, UPathFollowingComponent* PathFollowing)
+{
+	if (!IsValid(Agent) || !IsValid(Door) || !Door->HasAuthority())
+	{
+		return;
+	}
+
+	FDoorTraversalQueue& Queue = DoorQueues.FindOrAdd(Door);
+	const bool bAlreadyQueued = Queue.Agents.ContainsByPredicate([Agent](const FDoorTraversalAgent& Queued)
+	{
+		return Queued.Agent == Agent;
+	});
+	
+	if (bAlreadyQueued)
+	{
+		return;
+	}
+
+	FDoorTraversalAgent& Queued = Queue.Agents.Add_GetRef({ Agent, Door->GetDoorSide(Agent), GetWorld()->GetTimeSeconds() });
+	Queue.DrainedTime = -1.f;
+
+	if (IsValid(PathFollowing))
+	{
+		// Leave the queue when the move ends for any reason, e.g. the agent reached its goal or was given a new move
+		Queued.PathFollowing = PathFollowing;
+		Queued.MoveFinishedHandle = PathFollowing->OnRequestFinished.AddWeakLambda(this,
+			[this, WeakAgent = TWeakObjectPtr<AActor>(Agent), WeakDoor = TWeakObjectPtr<ADoor>(Door)]
+			(FAIRequestID, const FPathFollowingResult&)
+			{
+				DequeueAgent(WeakAgent.Get(), WeakDoor.Get());
+			});
+
+		// Wait at the door until it is open
+		if (Door->GetDoorState() != EDoorState::Open)
+		{
+			PathFollowing->PauseMove();
+			Queued.bPaused = true;
+		}
+	}
+}
+
+void UDoorTraversalSubsystem::DequeueAgent(const AActor* Agent, const ADoor* Door)
+{
+	FDoorTraversalQueue* Queue = DoorQueues.Find(Door);
+	const int32 Index = Queue ? Queue->Agents.IndexOfByPredicate([Agent](const FDoorTraversalAgent& Queued)
+	{
+		return Queued.Agent == Agent;
+	}) : INDEX_NONE;
+
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Preserve the order, the oldest agent decides first
+	FDoorTraversalAgent Queued = Queue->Agents[Index];
+	Queue->Agents.RemoveAt(Index);
+	if (Queue->Agents.IsEmpty())
+	{
+		Queue->DrainedTime = GetWorld()->GetTimeSeconds();
+	}
+
+	// Don't strand the agent, it was dequeued because its path changed or its move ended
+	ReleaseAgent(Queued, true);
+}
+
+void UDoorTraversalSubsystem::ReleaseAgent(FDoorTraversalAgent& Queued, bool bResume)
+{
+	UPathFollowingComponent* PathFollowing = Queued.PathFollowing.Get();
+	if (!PathFollowing)
+	{
+		return;
+	}
+
+	// Unbind first, aborting the move would dequeue the agent again
+	PathFollowing->OnRequestFinished.Remove(Queued.MoveFinishedHandle);
+	Queued.MoveFinishedHandle.Reset();
+
+	if (Queued.bPaused && PathFollowing->GetStatus() == EPathFollowingStatus::Paused)
+	{
+		Queued.bPaused = false;
+		if (bResume)
+		{
+			PathFollowing->ResumeMove();
+		}
+		else
+		{
+			PathFollowing->AbortMove(*this, FPathFollowingResultFlags::Blocked);
+		}
+	}
+}
+
+int32 UDoorTraversalSubsystem::GetNumQueuedAgents(const ADoor* Door) const
+{
+	const FDoorTraversalQueue* Queue = DoorQueues.Find(Door);
+	return Queue ? Queue->Agents.Num() : 0;
+}
+
+void UDoorTraversalSubsystem::UpdateQueue(const ADoor* Door, FDoorTraversalQueue& Queue, float TimeSeconds,
+	TArray<FDoorTraversalAgent>& OutReleasedAgents)
+{
+	const int32 NumAgents = Queue.Agents.Num();
+	if (NumAgents == 0)
+	{
+		return;
+	}
+
+	// Classify the whole queue against the door at once
+	TArray<FVector, TInlineAllocator<8>> AgentLocations;
+	TArray<EDoorSide, TInlineAllocator<8>> AgentSides;
+	AgentLocations.SetNumUninitialized(NumAgents);
+	AgentSides.SetNumUninitialized(NumAgents);
+	for (int32 i = 0; i < NumAgents; i++)
+	{
+		const AActor* Agent = Queue.Agents[i].Agent.Get();
+		AgentLocations[i] = Agent ? Agent->GetActorLocation() : FVector::ZeroVector;
+	}
+	UDoorStatics::GetDoorSidesFromLocations(AgentLocations, Door->GetDoorSidePlane(), AgentSides);
+
+	int32 Index = 0;
+	Queue.Agents.RemoveAll([&](const FDoorTraversalAgent& Queued)
+	{
+		const EDoorSide Side = AgentSides[Index++];
+		if (!Queued.Agent.IsValid() || Side != Queued.FromSide ||
+			TimeSeconds - Queued.QueueTime > DoorTraversalCVars::MaxWaitTime)
+		{
+			OutReleasedAgents.Add(Queued);
+			return true;
+		}
+		return false;
+	});
+
+	if (Queue.Agents.IsEmpty())
+	{
+		Queue.DrainedTime = TimeSeconds;
+	}
+}
+
+void UDoorTraversalSubsystem::DecideForQueue(ADoor* Door, FDoorTraversalQueue& Queue, float TimeSeconds)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDoorTraversalSubsystem::DecideForQueue);
+	
+	// Close the door behind the agents, but only if we opened it
+	if (Queue.Agents.IsEmpty())
+	{
+		if (!Queue.bOpenedForTraversal || DoorTraversalCVars::CloseDelay < 0.f)
+		{
+			Queue.bOpenedForTraversal = false;
+			return;
+		}
+
+		// Someone else closed it
+		if (!Door->IsDoorOpenOrOpening())
+		{
+			Queue.bOpenedForTraversal = false;
+			return;
+		}
+
+		if (TimeSeconds - Queue.DrainedTime < DoorTraversalCVars::CloseDelay)
+		{
+			return;
+		}
+
+		// The side only affects the motion when closing
+		EDoorState NewDoorState;
+		EDoorDirection NewDoorDirection;
+		EDoorMotion DoorMotion;
+		FGameplayTag FailReason;
+		if (UDoorStatics::ProgressDoorState(Door, Door->GetDoorState(), Door->GetDoorDirection(), EDoorSide::Front,
+			NewDoorState, NewDoorDirection, DoorMotion, FailReason))
+		{
+			Door->SetDoorState(NewDoorState, NewDoorDirection, nullptr);
+		}
+		Queue.bOpenedForTraversal = false;
+		return;
+	}
+
+	// Hold the door open while the queue drains
+	if (Door->IsDoorOpenOrOpening())
+	{
+		return;
+	}
+
+	// Evaluate once per side with agents waiting, the oldest agent on each side represents the rest
+	// Agent-specific overrides such as CanChangeDoorState() may reject one side and not the other
+	uint8 EvaluatedSides = 0;
+	for (const FDoorTraversalAgent& Queued : Queue.Agents)
+	{
+		const uint8 SideBit = 1 << static_cast<uint8>(Queued.FromSide);
+		if (EvaluatedSides & SideBit)
+		{
+			continue;
+		}
+		EvaluatedSides |= SideBit;
+
+		EDoorState NewDoorState;
+		EDoorDirection NewDoorDirection;
+		EDoorMotion DoorMotion;
+		FGameplayTag FailReason;
+		AActor* Agent = Queued.Agent.Get();
+		if (Door->ShouldDoorRespondToServerAgent(Agent, Queued.FromSide, NewDoorState, NewDoorDirection, DoorMotion,
+			FailReason))
+		{
+			UE_LOG(LogDoors, Verbose, TEXT("UDoorTraversalSubsystem::DecideForQueue: %s opening for %d agents"),
+				*GetNameSafe(Door), Queue.Agents.Num());
+			
+			Door->SetDoorState(NewDoorState, NewDoorDirection, Agent);
+			Queue.bOpenedForTraversal = true;
+			return;
+		}
+
+		// Both sides evaluated
+		if (EvaluatedSides == 0x3)
+		{
+			return;
+		}
+	}
+}
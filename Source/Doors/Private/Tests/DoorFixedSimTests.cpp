@@ -0,0 +1,31 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "System/DoorFixedSim.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace DoorFixedSimTests
+{
+	/**
+	 * Hashes of FDoorFixedSim::HashTraceScript() -- only update these when the simulation is meant to change,
+	 * as every recorded replay and rollback snapshot is invalidated along with them
+	 */
+	static constexpr uint32 GoldenLinear = 0x24F6A29A;
+	static constexpr uint32 GoldenSmoothStep = 0x58046E13;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDoorFixedSimTraceHashTest, "Doors.FixedSim.TraceHash",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDoorFixedSimTraceHashTest::RunTest(const FString& Parameters)
+{
+	using namespace DoorFixedSimTests;
+
+	TestEqual(TEXT("Linear trace matches the golden hash"), FDoorFixedSim::HashTraceScript(EDoorEasing::Linear), GoldenLinear);
+	TestEqual(TEXT("SmoothStep trace matches the golden hash"), FDoorFixedSim::HashTraceScript(EDoorEasing::SmoothStep), GoldenSmoothStep);
+	return true;
+}
+
+#endif
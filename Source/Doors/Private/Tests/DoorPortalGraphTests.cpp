@@ -0,0 +1,180 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "System/DoorPortalSubsystem.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace DoorPortalGraphTests
+{
+	/** Outside <-P0-> A <-P1-> B <-P2-> C, each room a 200cm box along X */
+	struct FTestGraph
+	{
+		FDoorPortalGraph Graph;
+		int32 A, B, C;
+		int32 P0, P1, P2;
+
+		FTestGraph()
+		{
+			const FBox Bounds(FVector(-100.f), FVector(100.f));
+			A = Graph.AddRoom(FTransform(FVector(0.f, 0.f, 0.f)), Bounds, true);
+			B = Graph.AddRoom(FTransform(FVector(200.f, 0.f, 0.f)), Bounds, true);
+			C = Graph.AddRoom(FTransform(FVector(400.f, 0.f, 0.f)), Bounds, true);
+			P0 = Graph.AddPortal(nullptr, DoorPortalOutside, A);
+			P1 = Graph.AddPortal(nullptr, A, B);
+			P2 = Graph.AddPortal(nullptr, B, C);
+		}
+
+		void SetOpenness(int32 Portal, float Openness)
+		{
+			Graph.SetPortalOpenness(Portal, Openness, Openness > 0.f);
+		}
+
+		FString Visible(int32 StartRoom) const
+		{
+			TBitArray<> VisibleRooms;
+			Graph.ComputeVisibleRooms(StartRoom, VisibleRooms);
+
+			FString Result;
+			for (int32 Room = 0; Room < VisibleRooms.Num(); Room++)
+			{
+				if (VisibleRooms[Room])
+				{
+					Result += Room == DoorPortalOutside ? TEXT("O") : FString::Printf(TEXT("%c"), TEXT('A') + Room - A);
+				}
+			}
+			return Result;
+		}
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDoorPortalGraphVisibilityTest, "Doors.Portal.Visibility",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDoorPortalGraphVisibilityTest::RunTest(const FString& Parameters)
+{
+	using namespace DoorPortalGraphTests;
+
+	FTestGraph Test;
+	TestEqual(TEXT("Find room A"), Test.Graph.FindRoom(FVector(0.f, 0.f, 0.f)), Test.A);
+	TestEqual(TEXT("Find room C"), Test.Graph.FindRoom(FVector(450.f, 0.f, 0.f), Test.A), Test.C);
+	TestEqual(TEXT("Find outside"), Test.Graph.FindRoom(FVector(0.f, 500.f, 0.f)), DoorPortalOutside);
+
+	TestEqual(TEXT("All closed"), Test.Visible(Test.A), TEXT("A"));
+
+	Test.SetOpenness(Test.P1, 1.f);
+	TestEqual(TEXT("A-B open, from A"), Test.Visible(Test.A), TEXT("AB"));
+	TestEqual(TEXT("A-B open, from C"), Test.Visible(Test.C), TEXT("C"));
+
+	Test.SetOpenness(Test.P2, 0.1f);
+	TestEqual(TEXT("A-B-C open, from A"), Test.Visible(Test.A), TEXT("ABC"));
+	TestEqual(TEXT("A-B-C open, from C"), Test.Visible(Test.C), TEXT("ABC"));
+
+	Test.SetOpenness(Test.P0, 1.f);
+	TestEqual(TEXT("Everything open, from outside"), Test.Visible(DoorPortalOutside), TEXT("OABC"));
+
+	Test.SetOpenness(Test.P1, 0.f);
+	TestEqual(TEXT("A-B closed, from A"), Test.Visible(Test.A), TEXT("OA"));
+	TestEqual(TEXT("A-B closed, from C"), Test.Visible(Test.C), TEXT("BC"));
+
+	// Removed rooms connect their portals to the outside
+	Test.Graph.RemoveRoom(Test.B);
+	TestEqual(TEXT("B removed, from C"), Test.Visible(Test.C), TEXT("OAC"));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDoorPortalGraphContainmentTest, "Doors.Portal.Containment",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDoorPortalGraphContainmentTest::RunTest(const FString& Parameters)
+{
+	using namespace DoorPortalGraphTests;
+
+	FTestGraph Test;
+	const FVector Extent(40.f);
+	TestEqual(TEXT("Box inside A"), Test.Graph.FindRoomContainingBox(FBox(FVector(-40.f), Extent)), Test.A);
+	TestEqual(TEXT("Box inside C"), Test.Graph.FindRoomContainingBox(FBox::BuildAABB(FVector(400.f, 0.f, 0.f), Extent)), Test.C);
+
+	// Anything crossing a room boundary is left unmanaged
+	TestEqual(TEXT("Box spanning A and B"), Test.Graph.FindRoomContainingBox(FBox::BuildAABB(FVector(100.f, 0.f, 0.f), Extent)),
+		DoorPortalOutside);
+	TestEqual(TEXT("Floor spanning every room"), Test.Graph.FindRoomContainingBox(
+		FBox(FVector(-100.f, -100.f, -110.f), FVector(500.f, 100.f, -90.f))), DoorPortalOutside);
+	TestEqual(TEXT("Box partly outside A"), Test.Graph.FindRoomContainingBox(FBox::BuildAABB(FVector(0.f, 100.f, 0.f), Extent)),
+		DoorPortalOutside);
+	TestEqual(TEXT("Box outside"), Test.Graph.FindRoomContainingBox(FBox::BuildAABB(FVector(0.f, 500.f, 0.f), Extent)),
+		DoorPortalOutside);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDoorPropagationCacheTest, "Doors.Portal.Propagation",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDoorPropagationCacheTest::RunTest(const FString& Parameters)
+{
+	using namespace DoorPortalGraphTests;
+
+	static constexpr float ClosedSound = 0.25f;
+	FTestGraph Test;
+	FDoorPropagationCache Cache;
+
+	// Closed doors transmit some sound and no sight
+	{
+		const FDoorPropagationTree& Sound = Cache.GetTree(Test.Graph, Test.A, EDoorPropagation::Sound, ClosedSound);
+		TestEqual(TEXT("Sound A->B closed"), Sound.Transmission[Test.B], ClosedSound);
+		TestEqual(TEXT("Sound A->C closed"), Sound.Transmission[Test.C], ClosedSound * ClosedSound);
+		TestEqual(TEXT("Sound A->C via P2"), Sound.ViaPortal[Test.C], Test.P2);
+		TestEqual(TEXT("Sound A->B via P1"), Sound.ViaPortal[Test.B], Test.P1);
+		TestEqual(TEXT("Sound source has no portal"), Sound.ViaPortal[Test.A], INDEX_NONE);
+
+		const FDoorPropagationTree& Sight = Cache.GetTree(Test.Graph, Test.A, EDoorPropagation::Sight, ClosedSound);
+		TestEqual(TEXT("Sight A->B closed"), Sight.Transmission[Test.B], 0.f);
+		TestEqual(TEXT("Sight A->B unreachable"), Sight.ViaPortal[Test.B], INDEX_NONE);
+	}
+
+	// Opening a door invalidates the trees that reach it
+	Test.SetOpenness(Test.P1, 1.f);
+	Test.SetOpenness(Test.P2, 0.5f);
+	Cache.InvalidatePortal(Test.Graph, Test.P1);
+	Cache.InvalidatePortal(Test.Graph, Test.P2);
+	{
+		const FDoorPropagationTree& Sight = Cache.GetTree(Test.Graph, Test.A, EDoorPropagation::Sight, ClosedSound);
+		TestEqual(TEXT("Sight A->B open"), Sight.Transmission[Test.B], 1.f);
+		TestEqual(TEXT("Sight A->C half open"), Sight.Transmission[Test.C], 0.5f);
+		TestEqual(TEXT("Sight A->C via P2"), Sight.ViaPortal[Test.C], Test.P2);
+		TestEqual(TEXT("Sight A->outside closed"), Sight.Transmission[DoorPortalOutside], 0.f);
+
+		const FDoorPropagationTree& Sound = Cache.GetTree(Test.Graph, Test.A, EDoorPropagation::Sound, ClosedSound);
+		TestEqual(TEXT("Sound A->C half open"), Sound.Transmission[Test.C], FMath::Lerp(ClosedSound, 1.f, 0.5f));
+	}
+
+	// A tree that can't reach the door is kept
+	const FDoorPropagationTree& OutsideSight = Cache.GetTree(Test.Graph, DoorPortalOutside, EDoorPropagation::Sight, ClosedSound);
+	TestEqual(TEXT("Sight outside->A closed"), OutsideSight.Transmission[Test.A], 0.f);
+	
+	Test.SetOpenness(Test.P2, 1.f);
+	Cache.InvalidatePortal(Test.Graph, Test.P2);
+	TestEqual(TEXT("Unreachable door keeps the outside tree"), OutsideSight.Generation, Cache.Generation);
+	TestEqual(TEXT("Reachable door invalidates A's tree"),
+		Cache.Trees[static_cast<uint8>(EDoorPropagation::Sight)][Test.A].Generation, 0u);
+	TestEqual(TEXT("Sight A->C recomputed"),
+		Cache.GetTree(Test.Graph, Test.A, EDoorPropagation::Sight, ClosedSound).Transmission[Test.C], 1.f);
+
+	// Closing the only way in cuts off everything behind it
+	Test.SetOpenness(Test.P1, 0.f);
+	Cache.InvalidatePortal(Test.Graph, Test.P1);
+	{
+		const FDoorPropagationTree& Sight = Cache.GetTree(Test.Graph, Test.A, EDoorPropagation::Sight, ClosedSound);
+		TestEqual(TEXT("Sight A->C behind closed door"), Sight.Transmission[Test.C], 0.f);
+		TestEqual(TEXT("Sight A->C unreachable"), Sight.ViaPortal[Test.C], INDEX_NONE);
+	}
+
+	// Structural changes invalidate everything
+	Cache.Invalidate();
+	TestNotEqual(TEXT("Invalidate discards every tree"), OutsideSight.Generation, Cache.Generation);
+	return true;
+}
+
+#endif
@@ -0,0 +1,67 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "DoorStatics.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDoorRepAlphaRoundTripTest, "Doors.RepAlpha.RoundTrip",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDoorRepAlphaRoundTripTest::RunTest(const FString& Parameters)
+{
+	TestEqual(TEXT("Default rep alpha is closed"), UDoorStatics::DequantizeDoorAlpha(FDoorRepAlpha().Value, FDoorRepAlpha().Bits), 0.f);
+
+	for (uint8 Bits = 4; Bits <= 16; Bits++)
+	{
+		const int32 MaxValue = (1 << (Bits - 1)) - 1;
+		const float Tolerance = 0.5f / MaxValue + KINDA_SMALL_NUMBER;
+
+		// Closed and fully open are exact at every bit depth
+		for (const float Alpha : { -1.f, 0.f, 1.f })
+		{
+			const float RoundTrip = UDoorStatics::DequantizeDoorAlpha(UDoorStatics::QuantizeDoorAlpha(Alpha, Bits), Bits);
+			TestEqual(FString::Printf(TEXT("%d bits: %.1f is exact"), Bits, Alpha), RoundTrip, Alpha);
+		}
+
+		for (int32 Step = -100; Step <= 100; Step++)
+		{
+			const float Alpha = Step * 0.01f;
+			const uint16 Quantized = UDoorStatics::QuantizeDoorAlpha(Alpha, Bits);
+			if (Quantized >= (1 << Bits))
+			{
+				AddError(FString::Printf(TEXT("%d bits: %.2f quantized to %u which doesn't fit"), Bits, Alpha, Quantized));
+				continue;
+			}
+
+			const float RoundTrip = UDoorStatics::DequantizeDoorAlpha(Quantized, Bits);
+			if (!FMath::IsNearlyEqual(RoundTrip, Alpha, Tolerance))
+			{
+				AddError(FString::Printf(TEXT("%d bits: %.2f round tripped to %f"), Bits, Alpha, RoundTrip));
+			}
+
+			// The bit depth travels with the value, the reader has no other way to know it
+			FDoorRepAlpha RepAlpha(Quantized, Bits);
+			bool bSuccess = false;
+			FBitWriter Writer(0, true);
+			RepAlpha.NetSerialize(Writer, nullptr, bSuccess);
+
+			FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+			FDoorRepAlpha ReadAlpha(0, 0);
+			ReadAlpha.NetSerialize(Reader, nullptr, bSuccess);
+
+			if (ReadAlpha.Value != RepAlpha.Value || ReadAlpha.Bits != RepAlpha.Bits || Reader.IsError() ||
+				Writer.GetNumBits() != 4 + Bits)
+			{
+				AddError(FString::Printf(TEXT("%d bits: NetSerialize of %u read back %u at %d bits from %lld bits"),
+					Bits, RepAlpha.Value, ReadAlpha.Value, ReadAlpha.Bits, Writer.GetNumBits()));
+			}
+		}
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,155 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "DoorStatics.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace DoorSideTests
+{
+	/** Offsets from the door that sit on the boundaries of GetSafeNormal2D() and the dot product */
+	static void AddEdgeCases(const FDoorSidePlane& Plane, TArray<FVector>& OutLocations)
+	{
+		const FVector Right = FVector::CrossProduct(FVector::UpVector, Plane.Forward.GetSafeNormal2D());
+		const double Tolerance = FMath::Sqrt(static_cast<double>(UE_SMALL_NUMBER));
+		const double Offsets[] = { 0.0, 1e-12, 1e-6, Tolerance * 0.999, Tolerance, Tolerance * 1.001, 1e-3, 1.0 };
+
+		for (const double Offset : Offsets)
+		{
+			// Exactly on the door, and either side of it along both axes
+			OutLocations.Add(Plane.Location + FVector(Offset, 0.0, 0.0));
+			OutLocations.Add(Plane.Location - FVector(Offset, 0.0, 0.0));
+			OutLocations.Add(Plane.Location + FVector(0.0, Offset, 0.0));
+			OutLocations.Add(Plane.Location - FVector(0.0, Offset, 0.0));
+			OutLocations.Add(Plane.Location + FVector(Offset, -Offset, 50.0));
+
+			// On the plane, where the dot product is zero or rounds to a signed zero
+			OutLocations.Add(Plane.Location + Right * Offset);
+			OutLocations.Add(Plane.Location - Right * Offset);
+			OutLocations.Add(Plane.Location + Right * Offset + Plane.Forward * 1e-9);
+			OutLocations.Add(Plane.Location + Right * Offset - Plane.Forward * 1e-9);
+		}
+
+		// 2D length of exactly one, Z must not contribute
+		OutLocations.Add(Plane.Location + FVector(1.0, 0.0, 0.0));
+		OutLocations.Add(Plane.Location + FVector(-1.0, 0.0, -100.0));
+		OutLocations.Add(Plane.Location + FVector(0.0, 1.0, 100.0));
+		OutLocations.Add(Plane.Location + FVector(0.0, -1.0, 0.0));
+	}
+
+	static FDoorSidePlane MakeRandomPlane(const FRandomStream& Stream)
+	{
+		FDoorSidePlane Plane;
+		Plane.Location = FVector(Stream.FRandRange(-1e5, 1e5), Stream.FRandRange(-1e5, 1e5), Stream.FRandRange(-1e3, 1e3));
+		Plane.Forward = Stream.GetUnitVector() * Stream.FRandRange(0.1, 10.0);
+		return Plane;
+	}
+
+	static FVector MakeRandomLocation(const FRandomStream& Stream, const FDoorSidePlane& Plane)
+	{
+		// Mostly near the door, where the side matters, with the occasional far avatar
+		const double Range = Stream.FRand() < 0.9f ? 500.0 : 1e5;
+		return Plane.Location + FVector(Stream.FRandRange(-Range, Range), Stream.FRandRange(-Range, Range),
+			Stream.FRandRange(-Range, Range));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDoorSideBatchTest, "Doors.Side.Batch",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDoorSideBatchTest::RunTest(const FString& Parameters)
+{
+	using namespace DoorSideTests;
+
+	const FRandomStream Stream(0x0D00);
+
+	TArray<FVector> Locations;
+	TArray<FDoorSidePlane> Planes;
+
+	// Edge cases against a fixed set of doors, including axis aligned and scaled forwards
+	const FDoorSidePlane FixedPlanes[] = {
+		{ FVector::ZeroVector, FVector::ForwardVector },
+		{ FVector(100.0, -250.0, 30.0), FVector::RightVector },
+		{ FVector(-3.5, 7.25, 0.0), FVector(1.0, 1.0, 0.0) },
+		{ FVector(1e5, 1e5, 0.0), FVector(-0.6, 0.8, 0.0) * 3.0 },
+		{ FVector(0.0, 0.0, -50.0), FVector(0.3, -0.2, 0.9) },
+	};
+	for (const FDoorSidePlane& Plane : FixedPlanes)
+	{
+		const int32 Start = Locations.Num();
+		AddEdgeCases(Plane, Locations);
+		Planes.Reserve(Locations.Num());
+		for (int32 i = Start; i < Locations.Num(); i++)
+		{
+			Planes.Add(Plane);
+		}
+	}
+
+	// Random pairs, not a multiple of four so the scalar tail is exercised
+	for (int32 i = 0; i < 10003; i++)
+	{
+		const FDoorSidePlane Plane = MakeRandomPlane(Stream);
+		Planes.Add(Plane);
+		Locations.Add(MakeRandomLocation(Stream, Plane));
+	}
+
+	TArray<EDoorSide> Sides;
+	Sides.SetNumUninitialized(Locations.Num());
+	UDoorStatics::GetDoorSidesFromLocations(Locations, Planes, Sides);
+
+	int32 NumMismatches = 0;
+	for (int32 i = 0; i < Locations.Num(); i++)
+	{
+		const EDoorSide Expected = UDoorStatics::GetDoorSideFromLocation(Locations[i], Planes[i].Location, Planes[i].Forward);
+		if (Sides[i] != Expected && NumMismatches++ < 10)
+		{
+			AddError(FString::Printf(TEXT("Pair %d: batch %d != scalar %d, avatar %s door %s forward %s"), i,
+				static_cast<int32>(Sides[i]), static_cast<int32>(Expected), *Locations[i].ToString(),
+				*Planes[i].Location.ToString(), *Planes[i].Forward.ToString()));
+		}
+	}
+	TestEqual(TEXT("Per pair mismatches"), NumMismatches, 0);
+
+	// Many avatars against a single door, at every batch size up to two full vector widths plus a tail
+	for (const FDoorSidePlane& Plane : FixedPlanes)
+	{
+		TArray<FVector> DoorLocations;
+		AddEdgeCases(Plane, DoorLocations);
+		for (int32 i = 0; i < 64; i++)
+		{
+			DoorLocations.Add(MakeRandomLocation(Stream, Plane));
+		}
+
+		for (int32 Num = 0; Num <= 9; Num++)
+		{
+			const TConstArrayView<FVector> View(DoorLocations.GetData(), Num);
+			TArray<EDoorSide> DoorSides;
+			DoorSides.SetNumUninitialized(Num);
+			UDoorStatics::GetDoorSidesFromLocations(View, Plane, DoorSides);
+			for (int32 i = 0; i < Num; i++)
+			{
+				TestEqual(FString::Printf(TEXT("Batch of %d, avatar %d"), Num, i), static_cast<int32>(DoorSides[i]),
+					static_cast<int32>(UDoorStatics::GetDoorSideFromLocation(View[i], Plane.Location, Plane.Forward)));
+			}
+		}
+
+		TArray<EDoorSide> DoorSides;
+		DoorSides.SetNumUninitialized(DoorLocations.Num());
+		UDoorStatics::GetDoorSidesFromLocations(DoorLocations, Plane, DoorSides);
+
+		int32 NumDoorMismatches = 0;
+		for (int32 i = 0; i < DoorLocations.Num(); i++)
+		{
+			if (DoorSides[i] != UDoorStatics::GetDoorSideFromLocation(DoorLocations[i], Plane.Location, Plane.Forward))
+			{
+				NumDoorMismatches++;
+			}
+		}
+		TestEqual(FString::Printf(TEXT("Single door %s mismatches"), *Plane.Forward.ToString()), NumDoorMismatches, 0);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,61 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "DoorTypes.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace DoorTargetDataPoolTests
+{
+	static constexpr int32 NumCycles = 10000;
+
+	/** Gather target data the way ADoor::GatherOptionalGraspTargetData() does, hand it to a handle, then release it */
+	template<typename AllocatorType>
+	static double RunCycles(AllocatorType&& Allocate)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumCycles; i++)
+		{
+			FDoorAbilityTargetData* Data = Allocate();
+			FGameplayAbilityTargetDataHandle Handle(Data);
+			Handle.Clear();
+		}
+		return FPlatformTime::Seconds() - StartTime;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDoorTargetDataPoolTest, "Doors.TargetData.Pool",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDoorTargetDataPoolTest::RunTest(const FString& Parameters)
+{
+	using namespace DoorTargetDataPoolTests;
+
+	// Pooled, through the class operator new
+	const int32 HeapAllocationsBefore = FDoorAbilityTargetData::GetNumHeapAllocations();
+	const double PoolTime = RunCycles([]
+	{
+		return new FDoorAbilityTargetData(EDoorState::Closed, EDoorDirection::Outward, EDoorSide::Front, 1.f, 1);
+	});
+	const int32 PoolHeapAllocations = FDoorAbilityTargetData::GetNumHeapAllocations() - HeapAllocationsBefore;
+
+	// Heap, placement new bypasses the pool and the handle's delete frees memory the pool doesn't own
+	int32 MallocAllocations = 0;
+	const double MallocTime = RunCycles([&MallocAllocations]
+	{
+		MallocAllocations++;
+		void* Memory = FMemory::Malloc(sizeof(FDoorAbilityTargetData), alignof(FDoorAbilityTargetData));
+		return new (Memory) FDoorAbilityTargetData(EDoorState::Closed, EDoorDirection::Outward, EDoorSide::Front, 1.f, 1);
+	});
+
+	AddInfo(FString::Printf(TEXT("Pool: %d target data allocations, %.1f ns per cycle"),
+		PoolHeapAllocations, PoolTime * 1e9 / NumCycles));
+	AddInfo(FString::Printf(TEXT("FMemory: %d target data allocations, %.1f ns per cycle"),
+		MallocAllocations, MallocTime * 1e9 / NumCycles));
+
+	TestEqual(TEXT("Pooled target data never touches the heap"), PoolHeapAllocations, 0);
+	return true;
+}
+
+#endif
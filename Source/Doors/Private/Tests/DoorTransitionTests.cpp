@@ -0,0 +1,132 @@
+﻿// Copyright (c) Jared Taylor
+
+
+#include "DoorStatics.h"
+#include "DoorTags.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace DoorTransitionTests
+{
+	struct FCase
+	{
+		EDoorState ClientState;
+		EDoorState DoorState;
+		EDoorDirection DoorDirection;
+		EDoorAccess Access;
+		EDoorOpenDirection OpenDirection;
+		EDoorSide Side;
+		EDoorMotion OpenMotion;
+
+		FString ToString() const
+		{
+			return FString::Printf(TEXT("Client %d Door %d Direction %d Access %d OpenDirection %d Side %d OpenMotion %d"),
+				static_cast<int32>(ClientState), static_cast<int32>(DoorState), static_cast<int32>(DoorDirection),
+				static_cast<int32>(Access), static_cast<int32>(OpenDirection), static_cast<int32>(Side),
+				static_cast<int32>(OpenMotion));
+		}
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDoorTransitionTableTest, "Doors.Transition.Table",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FDoorTransitionTableTest::RunTest(const FString& Parameters)
+{
+	using namespace DoorTransitionTests;
+
+	int32 NumFailures = 0;
+	auto Check = [this, &NumFailures](bool bCondition, const FCase& Case, const TCHAR* What)
+	{
+		if (!bCondition && NumFailures++ < 10)
+		{
+			AddError(FString::Printf(TEXT("%s: %s"), What, *Case.ToString()));
+		}
+	};
+
+	// Every valid combination of inputs, each checked against the rules the door follows
+	for (uint8 ClientState = 0; ClientState < 4; ClientState++)
+	for (uint8 DoorState = 0; DoorState < 4; DoorState++)
+	for (uint8 DoorDirection = 0; DoorDirection < 2; DoorDirection++)
+	for (uint8 Access = 0; Access < 3; Access++)
+	for (uint8 OpenDirection = 0; OpenDirection < 4; OpenDirection++)
+	for (uint8 Side = 0; Side < 2; Side++)
+	for (uint8 OpenMotion = 0; OpenMotion < 2; OpenMotion++)
+	{
+		const FCase Case = { static_cast<EDoorState>(ClientState), static_cast<EDoorState>(DoorState),
+			static_cast<EDoorDirection>(DoorDirection), static_cast<EDoorAccess>(Access),
+			static_cast<EDoorOpenDirection>(OpenDirection), static_cast<EDoorSide>(Side), static_cast<EDoorMotion>(OpenMotion) };
+
+		EDoorState NewState;
+		EDoorDirection NewDirection;
+		EDoorMotion Motion;
+		FGameplayTag FailReason;
+		const bool bResult = UDoorStatics::ResolveDoorTransition(Case.ClientState, Case.DoorState, Case.DoorDirection,
+			Case.Access, Case.OpenDirection, Case.Side, Case.OpenMotion, NewState, NewDirection, Motion, FailReason);
+
+		const bool bWantsOpen = Case.ClientState == EDoorState::Closed || Case.ClientState == EDoorState::Closing;
+		const bool bDoorOpen = Case.DoorState == EDoorState::Open || Case.DoorState == EDoorState::Opening;
+		const bool bFront = Case.Side == EDoorSide::Front;
+
+		if (!bResult)
+		{
+			Check(NewState == Case.DoorState && NewDirection == Case.DoorDirection, Case, TEXT("Failure changed the door"));
+		}
+
+		if (Case.OpenDirection == EDoorOpenDirection::Locked)
+		{
+			Check(!bResult && FailReason == FDoorTags::Door_Fail_Locked, Case, TEXT("Locked door did not fail as locked"));
+		}
+		else if (bWantsOpen == bDoorOpen)
+		{
+			Check(!bResult && FailReason == (bWantsOpen ? FDoorTags::Door_Fail_AlreadyOpen : FDoorTags::Door_Fail_AlreadyClosed),
+				Case, TEXT("Door already in the desired state did not fail"));
+		}
+		else if (!bWantsOpen)
+		{
+			// Closing ignores access, pushing from the front and pulling from behind
+			Check(bResult, Case, TEXT("Close failed"));
+			Check(NewState == EDoorState::Closing, Case, TEXT("Close did not start closing"));
+			Check(NewDirection == Case.DoorDirection, Case, TEXT("Close changed the door direction"));
+			Check(Motion == (bFront ? EDoorMotion::Push : EDoorMotion::Pull), Case, TEXT("Close used the wrong motion"));
+		}
+		else if (Case.Access == EDoorAccess::Behind && bFront)
+		{
+			Check(!bResult && FailReason == FDoorTags::Door_Fail_NoAccessFromFront, Case, TEXT("Opened without access from front"));
+		}
+		else if (Case.Access == EDoorAccess::Front && !bFront)
+		{
+			Check(!bResult && FailReason == FDoorTags::Door_Fail_NoAccessFromBack, Case, TEXT("Opened without access from back"));
+		}
+		else
+		{
+			Check(bResult, Case, TEXT("Open failed"));
+			Check(NewState == EDoorState::Opening, Case, TEXT("Open did not start opening"));
+
+			// The door always swings away from a push and towards a pull
+			const EDoorDirection AwayFromSide = bFront ? EDoorDirection::Inward : EDoorDirection::Outward;
+			const EDoorDirection TowardSide = bFront ? EDoorDirection::Outward : EDoorDirection::Inward;
+			Check(NewDirection == (Motion == EDoorMotion::Push ? AwayFromSide : TowardSide), Case,
+				TEXT("Open direction does not follow the motion"));
+
+			switch (Case.OpenDirection)
+			{
+			case EDoorOpenDirection::Outward:
+				Check(NewDirection == EDoorDirection::Outward, Case, TEXT("Outward only door did not open outward"));
+				break;
+			case EDoorOpenDirection::Inward:
+				Check(NewDirection == EDoorDirection::Inward, Case, TEXT("Inward only door did not open inward"));
+				break;
+			default:
+				Check(Motion == Case.OpenMotion, Case, TEXT("Bidirectional door ignored the preferred motion"));
+				break;
+			}
+		}
+	}
+
+	TestEqual(TEXT("Transition failures"), NumFailures, 0);
+	return true;
+}
+
+#endif
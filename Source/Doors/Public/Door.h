@@ -5,10 +5,14 @@
 #include "CoreMinimal.h"
 #include "DoorTypes.h"
 #include "GraspableOwner.h"
+#include "System/DoorFixedSim.h"
 #include "Door.generated.h"
 
 class UDoorSpriteWidgetComponent;
 class UDoorEditorVisualizer;
+class UDoorNavLinkComponent;
+class UPrimitiveComponent;
+class UPhysicsConstraintComponent;
 
 /**
  * Net-Predicted Doors for interaction (interacting)
@@ -41,6 +45,20 @@ public:
 	UPROPERTY(VisibleAnywhere, Category=Door)
 	TObjectPtr<UDoorSpriteWidgetComponent> DoorSprite;
 
+	/**
+	 * Navigation link for agents passing from the front of the door to the back
+	 * Optional, subclasses can opt out with ObjectInitializer.DoNotCreateDefaultSubobject(TEXT("NavLinkFront"))
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Door)
+	TObjectPtr<UDoorNavLinkComponent> NavLinkFront;
+
+	/**
+	 * Navigation link for agents passing from the back of the door to the front
+	 * Optional, subclasses can opt out with ObjectInitializer.DoNotCreateDefaultSubobject(TEXT("NavLinkBack"))
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Door)
+	TObjectPtr<UDoorNavLinkComponent> NavLinkBack;
+
 protected:
 	// Door State
 
@@ -58,8 +76,14 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Door)
 	EDoorDirection DoorDirection = EDoorDirection::Outward;
 	
+	/**
+	 * Door state, direction, access, open direction and open motion, along with the PredictionId of the interaction
+	 * that caused the door state -- the PredictionId allows the interacting client to reconcile its prediction
+	 * Packed into a single word so that e.g. locking and closing the door is a single property update
+	 * @see UDoorStatics::PackRepDoorState()
+	 */
 	UPROPERTY(ReplicatedUsing=OnRep_DoorState)
-	uint8 RepDoorState;
+	uint32 RepDoorState;
 
 	/** Disabling replication can produce better results for automatic doors */
 	UPROPERTY(EditAnywhere, AdvancedDisplay, BlueprintReadOnly, Category=Door)
@@ -68,6 +92,26 @@ protected:
 	/** Last avatar that interacted with the door */
 	TWeakObjectPtr<AActor> LastAvatar;
 
+	/** Door states we predicted locally that the server has not yet acknowledged, oldest first */
+	TArray<FDoorPredictedState, TInlineAllocator<4>> PendingPredictions;
+
+	/** Last PredictionId generated when gathering target data */
+	mutable uint8 LastPredictionId = 0;
+
+	/** PredictionId of the last interaction the server accepted, replicated with the door state */
+	uint8 AcceptedPredictionId = 0;
+
+	/** Owner of AcceptedPredictionId, replicated with the door state @see GetPredictionOwner() */
+	uint16 AcceptedPredictionOwner = 0;
+
+	/** PredictionId from the ability's activation target data, used when SetDoorState() isn't passed one */
+	mutable uint8 ActivationPredictionId = 0;
+
+	/** Owner of ActivationPredictionId @see GetPredictionOwner() */
+	mutable uint16 ActivationPredictionOwner = 0;
+
+	FTimerHandle PredictionTimeoutTimerHandle;
+
 	UPROPERTY(Transient, DuplicateTransient, BlueprintReadOnly, Category=Door)
 	float LastDoorStateChangeTime = 0.f;
 
@@ -80,6 +124,10 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Keep the door side plane and door spatial index up to date when the door moves */
+	void OnDoorTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
 	
 public:
 	virtual void Tick(float DeltaTime) override;
@@ -100,7 +148,19 @@ public:
 	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
 
 	UFUNCTION()
-	void OnRep_DoorState();
+	void OnRep_DoorState(uint32 OldRepDoorState);
+
+protected:
+	/** Apply the replicated door state, unless we're waiting for the server to acknowledge our prediction */
+	void ReconcileRepDoorState(const FDoorRepState& RepState);
+
+	/**
+	 * Pack the current door properties into RepDoorState and mark it dirty if anything changed
+	 * The door state and direction are left as last replicated while door state replication is disabled
+	 */
+	void UpdateRepDoorState();
+
+public:
 
 	/**
 	 * Set the door state replication enabled or disabled
@@ -110,13 +170,44 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category=Door)
 	void SetDoorStateReplicationEnabled(bool bEnabled, bool bReplicateNow = true);
 
+	UFUNCTION(BlueprintPure, Category=Door)
+	bool IsDoorStateReplicationEnabled() const { return bEnableDoorStateReplication; }
+
 	/**
-	 * How long to disable replication for the last avatar to change the door state
+	 * How long to wait for the server to acknowledge a predicted door state before deferring to the replicated state
 	 * This prevents the replication from fighting the prediction causing the door to snap back
-	 * Set to 0 to disable clearing the owner (who does not receive replication)
 	 */
 	UFUNCTION(BlueprintNativeEvent, BlueprintPure, Category=Door)
-	float GetLastAvatarReplicationExpirationTime() const;
+	float GetPredictionTimeout() const;
+
+	/** @return True if we have predicted door states that the server has not yet acknowledged */
+	UFUNCTION(BlueprintPure, Category=Door)
+	bool HasPendingPredictions() const { return !PendingPredictions.IsEmpty(); }
+
+	/**
+	 * Record the PredictionId the interaction ability activated with, called by GetDoorFromAbilityActivationTargetData()
+	 * The next SetDoorState() by the same avatar uses it if it wasn't passed a PredictionId
+	 */
+	void SetActivationPrediction(uint8 PredictionId, const AActor* Avatar) const;
+
+protected:
+	/** Generate a new PredictionId to identify a predicted interaction */
+	uint8 GeneratePredictionId() const;
+
+	/**
+	 * Identifies the player that owns a prediction, computed identically by the client and the server
+	 * PredictionIds are generated per client, without this every client's PredictionId 1 would acknowledge every other's
+	 * @return Low 12 bits of the avatar's PlayerId offset by one, or 0 if the avatar has no PlayerState
+	 */
+	static uint16 GetPredictionOwner(const AActor* Avatar);
+
+	/** Record a locally predicted door state, replication is held until the server acknowledges it or it times out */
+	void AddPendingPrediction(uint8 PredictionId, uint16 PredictionOwner, EDoorState NewDoorState, EDoorDirection NewDoorDirection);
+
+	/** The server never acknowledged our prediction, apply the replicated door state */
+	void OnPredictionTimeout();
+
+public:
 	
 	/**
 	 * Optionally override this to return a location that reflects the door mesh in its current state
@@ -132,6 +223,27 @@ public:
 		return { GetActorTransform().Rotator(), GetDoorLocation(), GetActorScale3D() };
 	}
 
+protected:
+	/** Cached GetDoorLocation() and GetDoorTransform() forward axis used to determine the door side */
+	mutable FDoorSidePlane CachedDoorSidePlane;
+
+	/** If true, CachedDoorSidePlane must be rebuilt before use */
+	mutable bool bDoorSidePlaneDirty = true;
+
+public:
+	/**
+	 * The plane that separates the front and back of the door, rebuilt only when the door moves or the door alpha changes
+	 * Not cached until BeginPlay
+	 */
+	const FDoorSidePlane& GetDoorSidePlane() const;
+
+	/**
+	 * Rebuild the door side plane next time it is used
+	 * Call this if your GetDoorLocation() override changes for reasons other than the door's transform or alpha
+	 */
+	UFUNCTION(BlueprintCallable, Category=Door)
+	void InvalidateDoorSidePlane() { bDoorSidePlaneDirty = true; }
+
 public:
 	/**
 	 * Last avatar that interacted with the door
@@ -158,7 +270,7 @@ public:
 	void GetRepDoorState(EDoorState& OutDoorState, EDoorDirection& OutDoorDirection) const;
 
 	UFUNCTION(BlueprintPure, Category=Door)
-	uint8 GetRepDoorStatePackedBits() const { return RepDoorState; }
+	uint8 GetRepDoorStatePackedBits() const { return static_cast<uint8>(RepDoorState & 0x7); }
 
 	/**
 	 * Call to set the door state
@@ -166,9 +278,11 @@ public:
 	 * @param NewDoorDirection The new direction of the door
 	 * @param Avatar The avatar that is interacting with the door -- not valid from replication
 	 * @param bClientSimulation If true, this change occurred from replication and not from predicted interaction
+	 * @param PredictionId Identifies the predicted interaction, from GetDoorFromAbilityActivationTargetData()
 	 */
-	UFUNCTION(BlueprintCallable, Category=Door, meta=(HidePin="bClientSimulation"))
-	void SetDoorState(EDoorState NewDoorState, EDoorDirection NewDoorDirection, AActor* Avatar, bool bClientSimulation = false);
+	UFUNCTION(BlueprintCallable, Category=Door, meta=(HidePin="bClientSimulation", AdvancedDisplay="PredictionId"))
+	void SetDoorState(EDoorState NewDoorState, EDoorDirection NewDoorDirection, AActor* Avatar, bool bClientSimulation = false,
+		uint8 PredictionId = 0);
 
 	/**
 	 * Called when the door state changes
@@ -294,19 +408,19 @@ public:
 	bool ShouldAutoDisableTickState() const { return bAutoDisableTickState && DoorAlphaMode != EAlphaMode::Disabled; }
 	
 	/** How long the door takes to open in seconds */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Time", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Time", EditConditionHides, ClampMin="0", UIMin="0", UIMax="3", Delta="0.05", ForceUnits="seconds"))
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Time", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Time||DoorAlphaMode==EAlphaMode::Fixed", EditConditionHides, ClampMin="0", UIMin="0", UIMax="3", Delta="0.05", ForceUnits="seconds"))
 	float DoorOpenOutwardTime = 0.5f;
 
 	/** How long the door takes to open in seconds */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Time", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Time", EditConditionHides, ClampMin="0", UIMin="0", UIMax="3", Delta="0.05", ForceUnits="seconds"))
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Time", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Time||DoorAlphaMode==EAlphaMode::Fixed", EditConditionHides, ClampMin="0", UIMin="0", UIMax="3", Delta="0.05", ForceUnits="seconds"))
 	float DoorOpenInwardTime = 0.5f;
 
 	/** How long the door takes to close in seconds */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Time", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Time", EditConditionHides, ClampMin="0", UIMin="0", UIMax="3", Delta="0.05", ForceUnits="seconds"))
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Time", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Time||DoorAlphaMode==EAlphaMode::Fixed", EditConditionHides, ClampMin="0", UIMin="0", UIMax="3", Delta="0.05", ForceUnits="seconds"))
 	float DoorCloseOutwardTime = 0.5f;
 
 	/** How long the door takes to close in seconds */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Time", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Time", EditConditionHides, ClampMin="0", UIMin="0", UIMax="3", Delta="0.05", ForceUnits="seconds"))
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Time", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Time||DoorAlphaMode==EAlphaMode::Fixed", EditConditionHides, ClampMin="0", UIMin="0", UIMax="3", Delta="0.05", ForceUnits="seconds"))
 	float DoorCloseInwardTime = 0.5f;
 	
 	/**
@@ -344,16 +458,139 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Time", meta=(EditCondition="DoorAlphaMode==EAlphaMode::InterpTo", EditConditionHides, ClampMin="0.0001", UIMin="0.0001", UIMax="1", Delta="0.01"))
 	float DoorInterpToTolerance = 0.01f;
 
+	/** Easing applied to the alpha when DoorAlphaMode is Fixed */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Time", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Fixed", EditConditionHides))
+	EDoorEasing DoorFixedEasing = EDoorEasing::Linear;
+
+protected:
+	/** Deterministic simulation used when DoorAlphaMode is Fixed */
+	FDoorFixedSim FixedSim;
+
+	/** Time not yet consumed by whole fixed ticks */
+	float FixedSimAccumulator = 0.f;
+
 public:
+	/** Deterministic simulation used when DoorAlphaMode is Fixed, snapshot GetFixedSim().State for rollback */
+	const FDoorFixedSim& GetFixedSim() const { return FixedSim; }
+
 	/**
-	 * How long to disable replication for the last avatar to change the door state
-	 * This prevents the replication from fighting the prediction causing the door to snap back
-	 * Set to 0 to disable clearing the owner (who does not receive replication)
+	 * Advance the deterministic simulation by whole ticks and apply its alpha, for replays and rollback
+	 * The door's tick calls this with the ticks elapsed since the last frame
 	 */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, AdvancedDisplay, Category="Door Time", meta=(EditCondition="DoorAlphaMode==EAlphaMode::InterpTo||DoorAlphaMode==EAlphaMode::InterpConstant||DoorAlphaMode==EAlphaMode::Disabled", EditConditionHides, ClampMin="0", UIMin="0", UIMax="3", Delta="0.05", ForceUnits="seconds"))
-	float LastAvatarReplicationExpirationTime = 2.5f;
+	void StepFixedSim(int32 NumTicks);
+
+	/** Restore a snapshot of the deterministic simulation, e.g. when rolling back */
+	void RestoreFixedSimState(const FDoorFixedSimState& SimState);
+
+protected:
+	void InitFixedSim();
+
+public:
+	// Door Physics
 
-	FTimerHandle LastAvatarReplicationTimerHandle;
+	/**
+	 * Which constraint drive moves the leaf when DoorAlphaMode is Physics
+	 * The constraint's reference pose must be the closed door, and positive motion must open outward
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Physics", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Physics", EditConditionHides))
+	EDoorPhysicsJoint DoorPhysicsJoint = EDoorPhysicsJoint::Hinge;
+
+	/** Swing1 angle of the hinge when the door is fully open */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Physics", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Physics&&DoorPhysicsJoint==EDoorPhysicsJoint::Hinge", EditConditionHides, ClampMin="1", UIMin="1", ClampMax="180", UIMax="180", Delta="5", ForceUnits="degrees"))
+	float DoorPhysicsOpenAngle = 90.f;
+
+	/** Distance along the constraint's X axis when the door is fully open */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Physics", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Physics&&DoorPhysicsJoint==EDoorPhysicsJoint::Prismatic", EditConditionHides, ClampMin="1", UIMin="1", UIMax="500", Delta="5", ForceUnits="cm"))
+	float DoorPhysicsOpenDistance = 100.f;
+
+	/** Position strength of the constraint motor */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Physics", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Physics", EditConditionHides, ClampMin="0", UIMin="0", UIMax="10000"))
+	float DoorPhysicsDriveStrength = 2000.f;
+
+	/** Velocity strength of the constraint motor, damps the leaf so it doesn't oscillate around the target */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Physics", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Physics", EditConditionHides, ClampMin="0", UIMin="0", UIMax="1000"))
+	float DoorPhysicsDriveDamping = 200.f;
+
+	/** Maximum force the motor can apply, 0 for unlimited -- limit this to let pawns hold the door */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Physics", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Physics", EditConditionHides, ClampMin="0", UIMin="0"))
+	float DoorPhysicsMaxForce = 0.f;
+
+	/** The door is considered open or closed once its alpha is this close to the target */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Physics", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Physics", EditConditionHides, ClampMin="0.001", UIMin="0.001", UIMax="0.2", Delta="0.005"))
+	float DoorPhysicsTolerance = 0.02f;
+
+	/** The leaf must also be moving slower than this, in alpha per second, before it settles and sleeps */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Physics", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Physics", EditConditionHides, ClampMin="0", UIMin="0", UIMax="1", Delta="0.01"))
+	float DoorPhysicsSettleSpeed = 0.1f;
+
+protected:
+	/** Alpha the constraint is currently driven toward */
+	float DoorPhysicsTargetAlpha = 0.f;
+
+	/** Prismatic only, the leaf's offset along the constraint's X axis when closed */
+	float DoorPhysicsClosedOffset = 0.f;
+
+public:
+	// Door Async Physics
+
+	/**
+	 * If true, alpha is integrated and GetDoorLeaf() is moved as a kinematic body in the physics step instead of on tick
+	 * Leaf collisions no longer depend on the frame rate, the alpha is applied back to the door on the game thread
+	 * Only for Time and InterpConstant alpha modes -- the leaf is placed natively so don't move it in OnDoorAlphaChanged
+	 * The leaf's pose at BeginPlay is its closed pose
+	 * @see UDoorAsyncPhysicsSubsystem
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Async Physics", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Time||DoorAlphaMode==EAlphaMode::InterpConstant", EditConditionHides))
+	bool bAsyncDoorMotion = false;
+
+	/** Rotation added to the leaf relative to its attach parent at alpha 1, negated at alpha -1 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Async Physics", meta=(EditCondition="bAsyncDoorMotion", EditConditionHides))
+	FRotator DoorLeafOpenRotation = { 0.f, 90.f, 0.f };
+
+	/** Offset added to the leaf relative to its attach parent at alpha 1, negated at alpha -1, e.g. for sliding doors */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Async Physics", meta=(EditCondition="bAsyncDoorMotion", EditConditionHides))
+	FVector DoorLeafOpenOffset = FVector::ZeroVector;
+
+protected:
+	/** True while UDoorAsyncPhysicsSubsystem is moving the door */
+	bool bAsyncDoorMotionActive = false;
+
+public:
+	/** @return How fast the alpha moves toward the target in the current state, in alpha per second -- Time and InterpConstant only */
+	UFUNCTION(BlueprintPure, Category=Door)
+	float GetDoorAlphaRate() const;
+
+	UFUNCTION(BlueprintPure, Category=Door)
+	bool IsDoorMotionAsync() const { return bAsyncDoorMotionActive; }
+
+	/** Called by UDoorAsyncPhysicsSubsystem when the physics step stops or resumes moving the door */
+	void SetDoorMotionAsync(bool bActive) { bAsyncDoorMotionActive = bActive; }
+
+public:
+	/** The constraint holding GetDoorLeaf() when DoorAlphaMode is Physics, override to return your constraint */
+	UFUNCTION(BlueprintNativeEvent, BlueprintPure, Category=Door)
+	UPhysicsConstraintComponent* GetDoorPhysicsConstraint() const;
+	virtual UPhysicsConstraintComponent* GetDoorPhysicsConstraint_Implementation() const { return nullptr; }
+
+protected:
+	/** Enable the constraint motor and drive it toward the current target */
+	void InitDoorPhysics();
+
+	/** Drive the constraint toward the target alpha, waking the leaf if the target changed */
+	void UpdateDoorPhysicsTarget(bool bForce = false);
+
+	/** @return Door alpha from the constraint's current angle or offset */
+	float GetDoorPhysicsAlpha() const;
+
+public:
+	/**
+	 * How long to wait for the server to acknowledge a predicted door state before deferring to the replicated state
+	 * Replicated door states that don't acknowledge our prediction are held until then, so they don't fight the prediction
+	 * Should exceed the highest round trip time you want to support without corrections
+	 * Set to 0 to always apply the replicated door state immediately
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, AdvancedDisplay, Category="Door Time", meta=(ClampMin="0", UIMin="0", UIMax="3", Delta="0.05", ForceUnits="seconds"))
+	float PredictionTimeout = 1.f;
 	
 public:
 	/** If true, don't notify on dedicated server -- used for VFX/SFX only */
@@ -482,6 +719,70 @@ public:
 	/** Trigger notifies due to change in alpha */
 	void HandleDoorAlphaNotifies(float OldDoorAlpha, float NewDoorAlpha);
 
+public:
+	// Door Alpha Replication
+
+	/**
+	 * If true, the door alpha is replicated while the door is moving
+	 * For doors whose alpha is driven externally, e.g. physics or manual animation
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Alpha", meta=(EditCondition="DoorAlphaMode==EAlphaMode::Disabled", EditConditionHides))
+	bool bReplicateDoorAlpha = false;
+
+	/** Number of bits used to quantize the door alpha over the -1 to 1 range */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Alpha", meta=(EditCondition="bReplicateDoorAlpha&&DoorAlphaMode==EAlphaMode::Disabled", EditConditionHides, ClampMin="4", UIMin="4", ClampMax="16", UIMax="16"))
+	int32 DoorAlphaReplicationBits = 8;
+
+	/** How many times per second the door alpha is sent while the door is moving slowly */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Alpha", meta=(EditCondition="bReplicateDoorAlpha&&DoorAlphaMode==EAlphaMode::Disabled", EditConditionHides, ClampMin="1", UIMin="1", UIMax="60", Delta="1", ForceUnits="hz"))
+	float DoorAlphaMinSendRate = 5.f;
+
+	/** How many times per second the door alpha is sent while the door is moving at or above DoorAlphaMaxSendRateSpeed */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Alpha", meta=(EditCondition="bReplicateDoorAlpha&&DoorAlphaMode==EAlphaMode::Disabled", EditConditionHides, ClampMin="1", UIMin="1", UIMax="60", Delta="1", ForceUnits="hz"))
+	float DoorAlphaMaxSendRate = 30.f;
+
+	/** Change in alpha per second at which the door alpha is sent at DoorAlphaMaxSendRate */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Alpha", meta=(EditCondition="bReplicateDoorAlpha&&DoorAlphaMode==EAlphaMode::Disabled", EditConditionHides, ClampMin="0.01", UIMin="0.01", UIMax="10", Delta="0.1"))
+	float DoorAlphaMaxSendRateSpeed = 2.f;
+
+	/** How far behind the server clients display the door alpha, this smooths out network jitter */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Alpha", meta=(EditCondition="bReplicateDoorAlpha&&DoorAlphaMode==EAlphaMode::Disabled", EditConditionHides, ClampMin="0", UIMin="0", UIMax="0.5", Delta="0.01", ForceUnits="seconds"))
+	float DoorAlphaInterpolationDelay = 0.1f;
+
+protected:
+	UPROPERTY(ReplicatedUsing=OnRep_DoorAlpha)
+	FDoorRepAlpha RepDoorAlpha;
+
+	/** Received door alpha waiting to be interpolated, oldest first */
+	TArray<FDoorAlphaSample, TInlineAllocator<8>> DoorAlphaSamples;
+
+	/** Last time the door alpha was sent */
+	float LastDoorAlphaSendTime = -1.f;
+
+	/** True if tick was enabled to interpolate the door alpha */
+	bool bTickEnabledForDoorAlpha = false;
+
+	FTimerHandle DoorAlphaSendTimerHandle;
+
+public:
+	bool ShouldReplicateDoorAlpha() const { return bReplicateDoorAlpha && DoorAlphaMode == EAlphaMode::Disabled; }
+
+protected:
+	UFUNCTION()
+	void OnRep_DoorAlpha();
+
+	/**
+	 * Send the door alpha if it changed, no faster than the send rate based on how fast the door is moving
+	 * @param bForce If true, send now regardless of the send rate
+	 */
+	void UpdateRepDoorAlpha(bool bForce = false);
+
+	/** Send the door alpha that was held back by the send rate */
+	void FlushRepDoorAlpha() { UpdateRepDoorAlpha(true); }
+
+	/** Interpolate the door alpha received from replication */
+	void TickRepDoorAlpha();
+
 public:
 	UFUNCTION(BlueprintPure, Category="Door Notify")
 	const TArray<FDoorNotify>& GetDoorNotifies() const;
@@ -499,19 +800,20 @@ public:
 protected:
 	// Door Access
 
-	/** Which side(s) of the door can we interact from */
-	UPROPERTY(Replicated, EditAnywhere, BlueprintReadOnly, Category=Door)
+	/** Which side(s) of the door can we interact from -- replicated via RepDoorState */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Door)
 	EDoorAccess DoorAccess = EDoorAccess::Bidirectional;
 
-	/** Which ways can the door open */
-	UPROPERTY(Replicated, EditAnywhere, BlueprintReadOnly, Category=Door)
+	/** Which ways can the door open -- replicated via RepDoorState */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Door)
 	EDoorOpenDirection DoorOpenDirection = EDoorOpenDirection::Bidirectional;
 
 	/**
 	 * Which action we prefer to use when opening the door
 	 * We might not always use the preferred motion, e.g. we would only push a door open if we're behind it and it opens outwards
+	 * Replicated via RepDoorState
 	 */
-	UPROPERTY(Replicated, EditAnywhere, BlueprintReadOnly, Category=Door)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Door)
 	EDoorMotion DoorOpenMotion = EDoorMotion::Push;
 
 protected:
@@ -599,7 +901,10 @@ public:
 	void K2_OnDoorOpenMotionChanged(EDoorMotion OldDoorOpenMotion, EDoorMotion NewDoorOpenMotion);
 
 protected:
-	/** If false, interaction will be rejected if the client's door side differs from the server's */
+	/**
+	 * If false, interaction will be rejected if the client's door side differs from the server's
+	 * The server rewinds to the client's timestamp before comparing, see UDoorRewindSubsystem
+	 */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Properties")
 	bool bTrustClientDoorSide = true;
 
@@ -664,6 +969,175 @@ public:
 	UPROPERTY(BlueprintReadOnly, Category=Door)
 	float LastStationaryTime = -1.f;
 
+public:
+	// Auto Door
+
+	/**
+	 * If true, the door opens automatically when a pawn is near it and closes once they leave
+	 * Pawns are tested against the trigger by UDoorProximitySubsystem, no overlap components are required
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Auto Door")
+	bool bAutoDoor = false;
+
+	/** Half size of the box around GetDoorLocation() that opens the door, in the door's space -- X extends front and back */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Auto Door", meta=(EditCondition="bAutoDoor", EditConditionHides))
+	FVector AutoDoorTriggerExtent = { 150.f, 100.f, 100.f };
+
+	/**
+	 * Pawns must move this much further away than the trigger before the door closes
+	 * Prevents the door flickering when a pawn stands at the edge of the trigger
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Auto Door", meta=(EditCondition="bAutoDoor", EditConditionHides, ClampMin="0", UIMin="0", UIMax="200", Delta="5", ForceUnits="cm"))
+	float AutoDoorHysteresis = 25.f;
+
+	/** How long the door stays open after the last pawn leaves the trigger */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Auto Door", meta=(EditCondition="bAutoDoor", EditConditionHides, ClampMin="0", UIMin="0", UIMax="5", Delta="0.1", ForceUnits="seconds"))
+	float AutoDoorHoldOpenTime = 1.f;
+
+	/**
+	 * If true, clients open the door locally the moment their own pawn enters the trigger instead of waiting for the server
+	 * The server still runs the trigger and its door state remains authoritative, nothing additional is replicated
+	 * Replicated closing states are held until the server agrees the door is open, or p.Door.Auto.PredictionTimeout elapses
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Auto Door", meta=(EditCondition="bAutoDoor", EditConditionHides))
+	bool bAutoDoorClientPredicted = false;
+
+public:
+	/** Enable or disable automatic opening and closing */
+	UFUNCTION(BlueprintCallable, Category=Door)
+	void SetAutoDoorEnabled(bool bEnabled);
+
+	/** Optionally override to prevent some pawns from opening the door, e.g. by team */
+	UFUNCTION(BlueprintNativeEvent, Category=Door)
+	bool CanPawnTriggerAutoDoor(const APawn* Pawn) const;
+	virtual bool CanPawnTriggerAutoDoor_Implementation(const APawn* Pawn) const { return true; }
+
+	/** @return True if this instance runs the auto door trigger, either as the server or as a predicting client */
+	bool ShouldRunAutoDoor() const { return bAutoDoor && (HasAuthority() || bAutoDoorClientPredicted); }
+
+	/** Discard the locally predicted auto door state and apply the replicated door state */
+	void ReconcileAutoDoorPrediction();
+
+public:
+	// Doorway
+
+	/**
+	 * What the door does when a pawn is in its doorway while it wants to close
+	 * Pawns are tested against the doorway by UDoorOccupancySubsystem, no overlap components or sweeps are required
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Doorway")
+	EDoorOccupiedResponse DoorwayOccupiedResponse = EDoorOccupiedResponse::None;
+
+	/** Half size of the box around GetDoorLocation() that the door swings through, in the door's space -- X extends front and back */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Doorway", meta=(EditCondition="DoorwayOccupiedResponse!=EDoorOccupiedResponse::None", EditConditionHides))
+	FVector DoorwayExtent = { 100.f, 100.f, 100.f };
+
+public:
+	/** @return True if a pawn that can block the door is inside its doorway */
+	UFUNCTION(BlueprintCallable, Category=Door)
+	bool IsDoorwayOccupied() const;
+
+	/** Pawns that can block the door inside its doorway */
+	UFUNCTION(BlueprintCallable, Category=Door)
+	void GetDoorwayOccupants(TArray<APawn*>& OutPawns) const;
+
+	/** Optionally override to prevent some pawns from blocking the door, e.g. dead pawns */
+	UFUNCTION(BlueprintNativeEvent, Category=Door)
+	bool CanPawnBlockDoorway(const APawn* Pawn) const;
+	virtual bool CanPawnBlockDoorway_Implementation(const APawn* Pawn) const { return true; }
+
+	/** @return True while the door is held mid-closing because its doorway is occupied */
+	UFUNCTION(BlueprintPure, Category=Door)
+	bool IsDoorwayHoldActive() const { return bDoorwayHold; }
+
+protected:
+	/** True while the door is held mid-closing because its doorway is occupied */
+	bool bDoorwayHold = false;
+	
+	/** @return True if the doorway response applies and a pawn is in the doorway */
+	bool ShouldDoorwayBlockClosing() const
+	{
+		return DoorwayOccupiedResponse != EDoorOccupiedResponse::None && IsDoorwayOccupied();
+	}
+
+	/** Hold or release the door, doors that aren't moved by their own tick are told to stop where they are */
+	void SetDoorwayHold(bool bHold);
+
+public:
+	// Door Push
+
+	/**
+	 * If true, the door's leaf pushes pawns out of its way while the door is moving
+	 * Resolved by UDoorPushSubsystem with batched async overlaps, there is no need to sweep the leaf or call
+	 * TriggerOnDoorAlphaChanged() on tick -- requires GetDoorLeaf()
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Push")
+	bool bPushPawns = false;
+
+public:
+	/** The moving part of the door that pushes pawns, override to return your door mesh */
+	UFUNCTION(BlueprintNativeEvent, BlueprintPure, Category=Door)
+	UPrimitiveComponent* GetDoorLeaf() const;
+	virtual UPrimitiveComponent* GetDoorLeaf_Implementation() const { return nullptr; }
+
+public:
+	// Door Net Update Rate
+
+	/**
+	 * If true, the door replicates frequently while active (in motion, on cooldown, or recently changed)
+	 * and drops to a minimal rate while idle, freeing replication budget for other actors
+	 * Changes that occur while idle are sent immediately via ForceNetUpdate()
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Replication")
+	bool bAdaptiveNetUpdateFrequency = true;
+
+	/** Net update frequency while the door is active */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Replication", meta=(EditCondition="bAdaptiveNetUpdateFrequency", EditConditionHides, ClampMin="1", UIMin="1", UIMax="100", Delta="1", ForceUnits="hz"))
+	float ActiveNetUpdateFrequency = 30.f;
+
+	/** Net update frequency while the door is idle */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Replication", meta=(EditCondition="bAdaptiveNetUpdateFrequency", EditConditionHides, ClampMin="0.1", UIMin="0.1", UIMax="10", Delta="0.1", ForceUnits="hz"))
+	float IdleNetUpdateFrequency = 1.f;
+
+	/** Net priority while the door is active */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Replication", meta=(EditCondition="bAdaptiveNetUpdateFrequency", EditConditionHides, ClampMin="0.1", UIMin="0.1", UIMax="5", Delta="0.1"))
+	float ActiveNetPriority = 2.f;
+
+	/** Net priority while the door is idle */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Replication", meta=(EditCondition="bAdaptiveNetUpdateFrequency", EditConditionHides, ClampMin="0.1", UIMin="0.1", UIMax="5", Delta="0.1"))
+	float IdleNetPriority = 1.f;
+
+	/** How long the door remains active after it last changed, in case it is interacted with again */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Door Replication", meta=(EditCondition="bAdaptiveNetUpdateFrequency", EditConditionHides, ClampMin="0", UIMin="0", UIMax="10", Delta="0.1", ForceUnits="seconds"))
+	float ActiveNetLingerTime = 2.f;
+
+protected:
+	/** True while replicating at the active rate */
+	bool bNetActive = false;
+
+	/** Keeps the door active for ActiveNetLingerTime after it last changed */
+	FTimerHandle NetActiveLingerTimerHandle;
+
+public:
+	/** @return True if the door is in motion, on cooldown, or changed within ActiveNetLingerTime */
+	UFUNCTION(BlueprintPure, Category=Door)
+	bool IsDoorNetActive() const;
+
+protected:
+	/**
+	 * Something about the door changed that clients need to know about
+	 * Raises the net update rate, and sends the change immediately if the door was idle
+	 */
+	void NotifyNetActivity();
+
+	/** Switch between the active and idle net update rate based on IsDoorNetActive() */
+	void UpdateNetUpdateRate();
+
+	/** Set the active or idle net update frequency and priority, regardless of the current rate */
+	void ApplyNetUpdateRate(bool bActive);
+
+	void OnNetActiveLingerFinished();
+
 protected:
 	/** Represents the value in -1 to 1 range by which the door is open or closed, -1 and 1 are fully open inward / outward and 0 is fully closed */
 	UPROPERTY(VisibleInstanceOnly, Category=Door, meta=(ClampMin="-1", UIMin="-1", ClampMax="1", UIMax="1", ForceUnits="Percent"))
@@ -690,12 +1164,108 @@ public:
 	 * @param NewDoorDirection The resulting new door direction to set
 	 * @param DoorMotion The resulting door motion to set
 	 * @param FailReason The reason the door failed to respond to the event -- useful for UI purposes such as showing a Lock icon
+	 * @param ClientTimestamp Server world time as estimated by the client, used to rewind when validating an untrusted client door side
 	 */
-	UFUNCTION(BlueprintCallable, BlueprintPure=false, Category=Door)
+	UFUNCTION(BlueprintCallable, BlueprintPure=false, Category=Door, meta=(AdvancedDisplay="ClientTimestamp", CPP_Default_ClientTimestamp="-1.000000"))
+	virtual bool ShouldAbilityRespondToDoorEvent(const AActor* Avatar, EDoorState ClientDoorState,
+		EDoorDirection ClientDoorDirection, EDoorSide ClientDoorSide, EDoorState& NewDoorState,
+		EDoorDirection& NewDoorDirection, EDoorMotion& DoorMotion, FGameplayTag& FailReason, float ClientTimestamp) const;
+
+	/** Overrides of this signature are no longer called, override the version with a ClientTimestamp instead */
+	UE_DEPRECATED(5.4, "Use ShouldAbilityRespondToDoorEvent() with a ClientTimestamp, pass -1 if there is none")
 	virtual bool ShouldAbilityRespondToDoorEvent(const AActor* Avatar, EDoorState ClientDoorState,
 		EDoorDirection ClientDoorDirection, EDoorSide ClientDoorSide, EDoorState& NewDoorState,
+		EDoorDirection& NewDoorDirection, EDoorMotion& DoorMotion, FGameplayTag& FailReason) const
+	{
+		return ShouldAbilityRespondToDoorEvent(Avatar, ClientDoorState, ClientDoorDirection, ClientDoorSide, NewDoorState,
+			NewDoorDirection, DoorMotion, FailReason, -1.f);
+	}
+
+	/**
+	 * Server-side interaction for agents the server controls, e.g. AI queued by UDoorTraversalSubsystem
+	 * Same as ShouldAbilityRespondToDoorEvent() using the door's current state, without the interaction rate limit
+	 * which only exists to drop spam from remote clients
+	 * @param Avatar The agent that is interacting with the door
+	 * @param DoorSide The side of the door the agent is on
+	 */
+	bool ShouldDoorRespondToServerAgent(const AActor* Avatar, EDoorSide DoorSide, EDoorState& NewDoorState,
 		EDoorDirection& NewDoorDirection, EDoorMotion& DoorMotion, FGameplayTag& FailReason) const;
 
+	/**
+	 * Call on the client before activating the interaction ability, to avoid sending interactions the server will reject
+	 * Mirrors ShouldAbilityRespondToDoorEvent() using the replicated door state, and outputs the same FailReason
+	 * @param Avatar The avatar that is interacting with the door
+	 * @param FailReason The reason the interaction would fail -- useful for UI purposes such as showing a Lock icon
+	 * @param bRejectionCertain True if the server will reject the interaction too, so it should not be sent
+	 *	Cooldown and motion are only certain if they outlast the round trip to the server
+	 *	CanDoorChangeToAnyState() and CanChangeDoorState() are never certain, they may depend on server-only data
+	 * @return True if the interaction is expected to succeed
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure=false, Category=Door)
+	bool PreValidateDoorInteraction(const AActor* Avatar, FGameplayTag& FailReason, bool& bRejectionCertain) const;
+
+	/**
+	 * Estimate how long until the door finishes its current motion
+	 * @return 0 if the door is stationary, or the remaining time can't be estimated for the DoorAlphaMode
+	 */
+	UFUNCTION(BlueprintPure, Category=Door)
+	float GetRemainingDoorMotionTime() const;
+
+protected:
+	/**
+	 * Evaluate an interaction with the door, shared by ShouldAbilityRespondToDoorEvent() and PreValidateDoorInteraction()
+	 * Does not include server-side arbitration
+	 */
+	bool EvaluateDoorInteraction(const AActor* Avatar, EDoorState ClientDoorState, EDoorDirection ClientDoorDirection,
+		EDoorSide ClientDoorSide, float ClientTimestamp, EDoorState& NewDoorState, EDoorDirection& NewDoorDirection,
+		EDoorMotion& DoorMotion, FGameplayTag& FailReason) const;
+
+protected:
+	/** Affordance for each EDoorSide, resolved on demand */
+	mutable FDoorAffordance CachedAffordances[2];
+
+	/** Bit per EDoorSide, set if the cached affordance is up to date */
+	mutable uint8 CachedAffordanceMask = 0;
+
+	/** Affordance from the door's state, excluding doorway occupancy which is never cached */
+	const FDoorAffordance& GetCachedDoorAffordance(EDoorSide Side) const;
+
+public:
+	/** Called when anything that affects the door's affordance changes, UI should query GetDoorAffordance() again */
+	UPROPERTY(BlueprintAssignable, Category=Door)
+	FOnDoorAffordanceInvalidated OnDoorAffordanceInvalidatedDelegate;
+
+	/**
+	 * What would happen if an avatar interacted with the door from the given side, cached until the door changes
+	 * Cheap enough to call every frame for the focused door, doorway occupancy is checked on every call
+	 * Avatar-specific overrides, CanDoorChangeToAnyState() and CanChangeDoorState(), are not included -- use
+	 * PreValidateDoorInteraction() when those matter
+	 */
+	UFUNCTION(BlueprintPure, Category=Door)
+	FDoorAffordance GetDoorAffordance(EDoorSide Side) const;
+
+	/** GetDoorAffordance() for the side of the door the avatar is on */
+	UFUNCTION(BlueprintPure, Category=Door)
+	FDoorAffordance GetDoorAffordanceForAvatar(const AActor* Avatar) const
+	{
+		return GetDoorAffordance(GetDoorSide(Avatar));
+	}
+
+	/** Discard the cached affordance, called when the door state, access, open direction, open motion or cooldown changes */
+	void InvalidateDoorAffordance();
+
+public:
+	/**
+	 * Whether AI can path through the door from the given side, opening it if required
+	 * Open doors can always be passed, closed doors can be passed if they are not locked and are accessible from the side
+	 * Cooldowns are not considered, the door will be usable by the time the agent arrives
+	 */
+	UFUNCTION(BlueprintPure, Category=Door)
+	bool CanAgentPassDoor(EDoorSide FromSide) const;
+
+	/** Update the navigation links' passability and cost, called when the door state, access or open direction changes */
+	void UpdateDoorNavLinks();
+
 public:
 	// General helpers
 
@@ -704,6 +1274,15 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category=Door)
 	EDoorSide GetDoorSide(const AActor* Avatar) const;
+
+	/**
+	 * Get the door side based on the avatar's location and the door's location at a previous point in time
+	 * Requires authority, falls back to the current door side if rewinding is not available
+	 * @param Avatar The avatar that is interacting with the door
+	 * @param Timestamp Server world time to evaluate the door side at
+	 */
+	UFUNCTION(BlueprintCallable, Category=Door)
+	EDoorSide GetDoorSideAtTime(const AActor* Avatar, float Timestamp) const;
 	
 public:
 	// Door State Helpers
@@ -25,6 +25,19 @@ public:
 	/** Unpack the door state and door direction from a single uint8 from replication */
 	static void UnpackDoorState(uint8 DoorStatePacked, EDoorState& OutDoorState, EDoorDirection& OutDoorDirection);
 
+	/**
+	 * Pack everything about the door that replicates into a single uint32
+	 * Bits 0-2: State & Direction (PackDoorState), 3-4: Access, 5-6: Open Direction, 7: Open Motion,
+	 * 8-15: PredictionId, 16-27: PredictionOwner, 28-31: DoorRepStateVersion
+	 */
+	static uint32 PackRepDoorState(const FDoorRepState& RepState);
+
+	/**
+	 * Unpack everything about the door that replicates from a single uint32 from replication
+	 * @return False if the packed state was written with a different DoorRepStateVersion
+	 */
+	static bool UnpackRepDoorState(uint32 RepDoorStatePacked, FDoorRepState& OutRepState);
+
 	/** Pack the door state and door direction and door side into a single uint8 for replication */
 	static uint8 PackTargetDataDoorState(EDoorState DoorState, EDoorDirection DoorDirection, EDoorSide DoorSide);
 	
@@ -32,10 +45,35 @@ public:
 	static void UnpackTargetDataDoorState(uint8 DoorStatePacked, EDoorState& OutDoorState,
 		EDoorDirection& OutDoorDirection, EDoorSide& OutDoorSide);
 	
-	/** Unpack any data sent from the gameplay ability event data payload */
+	/**
+	 * Quantize the door alpha in the -1 to 1 range to the given bit depth for replication
+	 * The range is symmetric so that 0 (closed) and -1 / 1 (open) are represented exactly
+	 */
+	static uint16 QuantizeDoorAlpha(float DoorAlpha, uint8 Bits);
+
+	/** Restore the door alpha from a value quantized with QuantizeDoorAlpha() */
+	static float DequantizeDoorAlpha(uint16 QuantizedAlpha, uint8 Bits);
+
+	/**
+	 * Unpack any data sent from the gameplay ability event data payload
+	 * @param ClientTimestamp Server world time as estimated by the client, pass to ShouldAbilityRespondToDoorEvent() for lag compensation
+	 * @param PredictionId Identifies the client's predicted interaction, pass to SetDoorState() on both client and server
+	 *	If the event targets the door, SetDoorState() uses it automatically when the avatar doesn't pass one
+	 */
 	UFUNCTION(BlueprintCallable, Category=Door, meta=(ExpandEnumAsExecs="Validate"))
 	static void GetDoorFromAbilityActivationTargetData(const FGameplayEventData& EventData, EDoorValid& Validate,
-		EDoorState& DoorState, EDoorDirection& DoorDirection, EDoorSide& DoorSide);
+		EDoorState& DoorState, EDoorDirection& DoorDirection, EDoorSide& DoorSide, float& ClientTimestamp,
+		uint8& PredictionId);
+
+	UE_DEPRECATED(5.4, "Use GetDoorFromAbilityActivationTargetData() with ClientTimestamp and PredictionId")
+	static void GetDoorFromAbilityActivationTargetData(const FGameplayEventData& EventData, EDoorValid& Validate,
+		EDoorState& DoorState, EDoorDirection& DoorDirection, EDoorSide& DoorSide)
+	{
+		float ClientTimestamp;
+		uint8 PredictionId;
+		GetDoorFromAbilityActivationTargetData(EventData, Validate, DoorState, DoorDirection, DoorSide, ClientTimestamp,
+			PredictionId);
+	}
 	
 	/**
 	 * Based on the current state of the door, if we interact, then we're requesting it to go into a new state
@@ -54,6 +92,21 @@ public:
 	static bool ProgressDoorState(const ADoor* Door, EDoorState DoorState, EDoorDirection DoorDirection,
 		EDoorSide DoorSide, EDoorState& NewDoorState, EDoorDirection& NewDoorDirection, EDoorMotion& Motion, FGameplayTag& FailReason);
 
+	/**
+	 * Resolve a door transition from raw door properties, used by ProgressDoorState()
+	 * @param ClientDoorState The door state as seen by the client
+	 * @param DoorState The door's current state
+	 * @param DoorDirection The door's current direction
+	 * @param DoorAccess Which side the door can be opened from
+	 * @param DoorOpenDirection Which way the door can open
+	 * @param DoorSide The side of the door that we are standing on
+	 * @param DoorOpenMotion The motion the door prefers to open with
+	 * @return True if we have a valid state the door can change to
+	 */
+	static bool ResolveDoorTransition(EDoorState ClientDoorState, EDoorState DoorState, EDoorDirection DoorDirection,
+		EDoorAccess DoorAccess, EDoorOpenDirection DoorOpenDirection, EDoorSide DoorSide, EDoorMotion DoorOpenMotion,
+		EDoorState& NewDoorState, EDoorDirection& NewDoorDirection, EDoorMotion& Motion, FGameplayTag& FailReason);
+
 	/** 
 	 * Get the target door state based on the current state of the door, when we want to interact with it
 	 * @param FromState The current state of the door
@@ -68,6 +121,39 @@ public:
 	UFUNCTION(BlueprintCallable, Category=Door)
 	static EDoorSide GetDoorSide(const AActor* Avatar, const ADoor* Door);
 
+	/**
+	 * Get the door side from raw locations, used when the avatar or door are not at their current location
+	 * e.g. when rewinding to a previous point in time for lag compensation
+	 * @param AvatarLocation The location of the avatar
+	 * @param DoorLocation The location of the door, see ADoor::GetDoorLocation()
+	 * @param DoorForward The scaled forward axis of the door transform, see ADoor::GetDoorTransform()
+	 */
+	static EDoorSide GetDoorSideFromLocation(const FVector& AvatarLocation, const FVector& DoorLocation, const FVector& DoorForward);
+
+	/**
+	 * Get the door side for many avatars against a single door, e.g. for AI crowds
+	 * Results are identical to calling GetDoorSideFromLocation() for each avatar
+	 * @param AvatarLocations The locations of the avatars
+	 * @param Plane The door's side plane, see ADoor::GetDoorSidePlane()
+	 * @param OutSides Receives the door side for each avatar, must be the same size as AvatarLocations
+	 */
+	static void GetDoorSidesFromLocations(TConstArrayView<FVector> AvatarLocations, const FDoorSidePlane& Plane,
+		TArrayView<EDoorSide> OutSides);
+
+	/**
+	 * Get the door side for many avatar and door pairs
+	 * Results are identical to calling GetDoorSideFromLocation() for each pair
+	 * @param AvatarLocations The locations of the avatars
+	 * @param Planes The side plane of the door each avatar is paired with, must be the same size as AvatarLocations
+	 * @param OutSides Receives the door side for each pair, must be the same size as AvatarLocations
+	 */
+	static void GetDoorSidesFromLocations(TConstArrayView<FVector> AvatarLocations, TConstArrayView<FDoorSidePlane> Planes,
+		TArrayView<EDoorSide> OutSides);
+
+	/** Get the door side for each avatar, invalid avatars are considered to be in front of the door */
+	UFUNCTION(BlueprintCallable, Category=Door)
+	static void GetDoorSides(const TArray<AActor*>& Avatars, const ADoor* Door, TArray<EDoorSide>& DoorSides);
+
 	/** Convenience function for passing an interactable component on the door, to retrieve and cast the door owner */
 	UFUNCTION(BlueprintPure, Category=Door)
 	static ADoor* GetOwningDoorFromComponent(const USceneComponent* Component);
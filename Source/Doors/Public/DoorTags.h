@@ -12,6 +12,9 @@ namespace FDoorTags
 	DOORS_API UE_DECLARE_GAMEPLAY_TAG_EXTERN(Door_Fail_InMotion);
 	DOORS_API UE_DECLARE_GAMEPLAY_TAG_EXTERN(Door_Fail_ClientDoorSide);
 	DOORS_API UE_DECLARE_GAMEPLAY_TAG_EXTERN(Door_Fail_CanChangeDoorState);
+	DOORS_API UE_DECLARE_GAMEPLAY_TAG_EXTERN(Door_Fail_RateLimited);
+	DOORS_API UE_DECLARE_GAMEPLAY_TAG_EXTERN(Door_Fail_Contested);
+	DOORS_API UE_DECLARE_GAMEPLAY_TAG_EXTERN(Door_Fail_DoorwayOccupied);
 	
 	DOORS_API UE_DECLARE_GAMEPLAY_TAG_EXTERN(Door_Fail_DoorNotValid);
 	DOORS_API UE_DECLARE_GAMEPLAY_TAG_EXTERN(Door_Fail_Locked);
@@ -105,6 +105,50 @@ enum class EAlphaMode : uint8
 	InterpConstant		UMETA(ToolTip="Alpha is interpolated on tick to the target value at a constant rate"),
 	InterpTo			UMETA(ToolTip="Alpha is interpolated on tick to the target value based on distance -- WARNING: Framerate dependent do not use if doors can collide with player characters!"),
 	Disabled			UMETA(ToolTip="Alpha will not update on tick and must be handled manually. Door will not tick."),
+	Physics				UMETA(ToolTip="A constraint motor drives the door leaf to the target and alpha is read back from the constraint"),
+	Fixed				UMETA(ToolTip="Alpha is stepped in fixed point at p.Door.Fixed.TickRate using the door times. Deterministic across machines for replays and rollback"),
+};
+
+/**
+ * Easing applied to the door alpha by the deterministic simulation, see FDoorFixedSim
+ */
+UENUM(BlueprintType)
+enum class EDoorEasing : uint8
+{
+	Linear				UMETA(ToolTip="Constant speed"),
+	SmoothStep			UMETA(ToolTip="Accelerates from the start and decelerates into the end"),
+};
+
+/**
+ * Which constraint drive moves the door leaf when the alpha mode is Physics
+ */
+UENUM(BlueprintType)
+enum class EDoorPhysicsJoint : uint8
+{
+	Hinge				UMETA(ToolTip="The leaf swings around the constraint's Swing1 (Z) axis"),
+	Prismatic			UMETA(ToolTip="The leaf slides along the constraint's X axis"),
+};
+
+/**
+ * What is propagating through doors between rooms, see UDoorPortalSubsystem
+ */
+UENUM(BlueprintType)
+enum class EDoorPropagation : uint8
+{
+	Sound				UMETA(ToolTip="Closed doors muffle sound but don't block it"),
+	Sight				UMETA(ToolTip="Closed doors block line of sight"),
+};
+
+/**
+ * What a door does when a pawn is in its doorway while it wants to close, see UDoorOccupancySubsystem
+ */
+UENUM(BlueprintType)
+enum class EDoorOccupiedResponse : uint8
+{
+	None				UMETA(ToolTip="Close regardless of pawns in the doorway"),
+	Refuse				UMETA(ToolTip="Don't start closing while the doorway is occupied, but finish closing once started"),
+	Pause				UMETA(ToolTip="Don't start closing while the doorway is occupied, and stop moving while closing until it is clear"),
+	Reverse				UMETA(ToolTip="Don't start closing while the doorway is occupied, and open again if it becomes occupied while closing"),
 };
 
 UENUM(BlueprintType)
@@ -117,6 +161,46 @@ enum class EDoorValid : uint8
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_FiveParams(FOnDoorStateChanged, const ADoor*, Door, const EDoorState&, OldState,
 	const EDoorState&, NewState, const EDoorDirection&, OldDoorDirection, const EDoorDirection&, NewDoorDirection);
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDoorAffordanceInvalidated, const ADoor*, Door);
+
+/**
+ * What would happen if an avatar interacted with the door from a given side
+ * Used by focus systems and UI prompts to show e.g. "Open", "Pull" or a Lock icon
+ */
+USTRUCT(BlueprintType)
+struct DOORS_API FDoorAffordance
+{
+	GENERATED_BODY()
+
+	FDoorAffordance()
+		: bCanInteract(false)
+		, NewDoorState(EDoorState::Closed)
+		, NewDoorDirection(EDoorDirection::Outward)
+		, Motion(EDoorMotion::Push)
+		, FailReason(FGameplayTag::EmptyTag)
+	{}
+
+	/** True if the interaction is expected to succeed */
+	UPROPERTY(BlueprintReadOnly, Category=Door)
+	bool bCanInteract;
+
+	/** The door state the interaction would result in */
+	UPROPERTY(BlueprintReadOnly, Category=Door)
+	EDoorState NewDoorState;
+
+	/** The door direction the interaction would result in */
+	UPROPERTY(BlueprintReadOnly, Category=Door)
+	EDoorDirection NewDoorDirection;
+
+	/** Whether the avatar would push or pull the door */
+	UPROPERTY(BlueprintReadOnly, Category=Door)
+	EDoorMotion Motion;
+
+	/** Why the interaction would fail, if it would */
+	UPROPERTY(BlueprintReadOnly, Category=Door)
+	FGameplayTag FailReason;
+};
+
 /**
  * We send the door's data to the ability from the client to the client's ability and from the client to the server's ability
  * This allows the client to request specific states rather than a generic interaction, which will fight latency esp. when other players are interacting
@@ -128,17 +212,36 @@ struct DOORS_API FDoorAbilityTargetData : public FGameplayAbilityTargetData
 
 	FDoorAbilityTargetData()
 		: PackedState(0)
+		, ClientTimestamp(-1.f)
+		, PredictionId(0)
 	{}
 
 	FDoorAbilityTargetData(const EDoorState& InDoorState, const EDoorDirection& InDoorDirection,
-		const EDoorSide& InDoorSide);
+		const EDoorSide& InDoorSide, float InClientTimestamp = -1.f, uint8 InPredictionId = 0);
 
 	UPROPERTY(BlueprintReadOnly, Category=Door)
 	uint8 PackedState;
 
+	/**
+	 * Server world time as estimated by the client when the target data was gathered
+	 * Used by the server to rewind the avatar and door when validating the client's door side
+	 * Negative if not available
+	 */
+	UPROPERTY(BlueprintReadOnly, Category=Door)
+	float ClientTimestamp;
+
+	/**
+	 * Identifies the client's predicted interaction, the server echoes this back with the replicated door state
+	 * so the client can reconcile its prediction, 0 if not predicted
+	 */
+	UPROPERTY(BlueprintReadOnly, Category=Door)
+	uint8 PredictionId;
+
 	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
 	{
 		Ar << PackedState;
+		Ar << ClientTimestamp;
+		Ar << PredictionId;
 		return true;
 	}
 	
@@ -146,6 +249,21 @@ struct DOORS_API FDoorAbilityTargetData : public FGameplayAbilityTargetData
 	{
 		return StaticStruct();
 	}
+
+	/**
+	 * Target data is gathered for every interaction, so it is allocated from a fixed pool rather than the heap
+	 * Falls back to the heap when the pool is exhausted, or for derived types that don't fit a pool block
+	 * Deleting is safe regardless of where the memory came from, e.g. instances created by net serialization
+	 */
+	static void* operator new(size_t Size);
+	static void operator delete(void* Ptr);
+
+	/** Number of instances that fell back to the heap since startup, to verify the pool is sized for the game */
+	static int32 GetNumHeapAllocations();
+
+	/** Required so placement new used by UScriptStruct is not hidden by the pooled operator new */
+	static void* operator new(size_t Size, void* Ptr) { return Ptr; }
+	static void operator delete(void* Ptr, void* Place) {}
 };
 
 template<>
@@ -157,6 +275,156 @@ struct TStructOpsTypeTraits<FDoorAbilityTargetData> : TStructOpsTypeTraitsBase2<
 	};
 };
 
+/**
+ * Door alpha quantized over the -1 to 1 range for replication
+ * Serializes a 4 bit header with the bit depth, followed by the quantized value
+ */
+USTRUCT()
+struct DOORS_API FDoorRepAlpha
+{
+	GENERATED_BODY()
+
+	/** The quantized midpoint, so a default alpha dequantizes to 0 (closed) rather than -1 */
+	FDoorRepAlpha()
+		: Value((1 << 7) - 1)
+		, Bits(8)
+	{}
+
+	FDoorRepAlpha(uint16 InValue, uint8 InBits)
+		: Value(InValue)
+		, Bits(InBits)
+	{}
+
+	/** Quantized alpha, see UDoorStatics::QuantizeDoorAlpha() */
+	UPROPERTY()
+	uint16 Value;
+
+	/** Bit depth the alpha was quantized to */
+	UPROPERTY()
+	uint8 Bits;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		uint8 BitsHeader = Ar.IsSaving() ? static_cast<uint8>(FMath::Clamp<int32>(Bits, 1, 16) - 1) : 0;
+		Ar.SerializeBits(&BitsHeader, 4);
+		Bits = BitsHeader + 1;
+
+		uint32 SerializedValue = Ar.IsSaving() ? Value : 0;
+		Ar.SerializeBits(&SerializedValue, Bits);
+		Value = static_cast<uint16>(SerializedValue);
+
+		bOutSuccess = true;
+		return true;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FDoorRepAlpha> : TStructOpsTypeTraitsBase2<FDoorRepAlpha>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/**
+ * Door alpha received from replication, buffered for interpolation
+ */
+struct DOORS_API FDoorAlphaSample
+{
+	FDoorAlphaSample(float InTime, float InAlpha)
+		: Time(InTime)
+		, Alpha(InAlpha)
+	{}
+
+	float Time;
+	float Alpha;
+};
+
+/**
+ * A door state the client predicted locally that the server has not yet acknowledged
+ */
+struct DOORS_API FDoorPredictedState
+{
+	FDoorPredictedState(uint8 InPredictionId, uint16 InPredictionOwner, EDoorState InDoorState, EDoorDirection InDoorDirection)
+		: PredictionId(InPredictionId)
+		, PredictionOwner(InPredictionOwner)
+		, DoorState(InDoorState)
+		, DoorDirection(InDoorDirection)
+	{}
+
+	uint8 PredictionId;
+	uint16 PredictionOwner;
+	EDoorState DoorState;
+	EDoorDirection DoorDirection;
+
+	/** @return True if the replicated state was caused by this prediction, ids are only unique per owner */
+	bool IsCausedBy(uint8 RepPredictionId, uint16 RepPredictionOwner) const
+	{
+		return PredictionId == RepPredictionId && PredictionOwner == RepPredictionOwner;
+	}
+
+	/** @return True if the replicated state confirms this prediction, including the door completing its motion */
+	bool IsAcknowledgedBy(EDoorState RepDoorState, EDoorDirection RepDoorDirection) const
+	{
+		if (RepDoorDirection != DoorDirection)
+		{
+			return false;
+		}
+		return RepDoorState == DoorState ||
+			(DoorState == EDoorState::Opening && RepDoorState == EDoorState::Open) ||
+			(DoorState == EDoorState::Closing && RepDoorState == EDoorState::Closed);
+	}
+};
+
+/**
+ * Bit layout version of the replicated door state, increment when the layout changes
+ * Clients discard a replicated door state with a different version rather than misinterpreting it
+ */
+static constexpr uint8 DoorRepStateVersion = 2;
+
+/**
+ * Everything about the door that replicates, unpacked from the single replicated integer
+ * See UDoorStatics::PackRepDoorState() for the bit layout
+ */
+struct DOORS_API FDoorRepState
+{
+	EDoorState DoorState = EDoorState::Closed;
+	EDoorDirection DoorDirection = EDoorDirection::Outward;
+	EDoorAccess DoorAccess = EDoorAccess::Bidirectional;
+	EDoorOpenDirection DoorOpenDirection = EDoorOpenDirection::Bidirectional;
+	EDoorMotion DoorOpenMotion = EDoorMotion::Push;
+
+	/** PredictionId of the interaction that caused the door state, 0 if not predicted */
+	uint8 PredictionId = 0;
+
+	/**
+	 * Identifies the player whose interaction caused the door state, 0 if not predicted
+	 * PredictionIds are generated by each client, so they only identify a prediction together with their owner
+	 */
+	uint16 PredictionOwner = 0;
+
+	/** @return True if the door state, direction, or prediction differ */
+	bool HasDoorStateChanged(const FDoorRepState& Other) const
+	{
+		return DoorState != Other.DoorState || DoorDirection != Other.DoorDirection ||
+			PredictionId != Other.PredictionId || PredictionOwner != Other.PredictionOwner;
+	}
+};
+
+/**
+ * The plane that separates the front and back of the door, cached by ADoor so that determining the door side
+ * does not rebuild the door transform or call GetDoorLocation()
+ */
+struct DOORS_API FDoorSidePlane
+{
+	/** ADoor::GetDoorLocation() */
+	FVector Location = FVector::ZeroVector;
+
+	/** Scaled forward axis of ADoor::GetDoorTransform() */
+	FVector Forward = FVector::ForwardVector;
+};
+
 /**
  * Notify when door reaches a certain alpha (percentage of in progress/motion door state)
  * Useful for playing sounds and VFX at certain points in the door's animation
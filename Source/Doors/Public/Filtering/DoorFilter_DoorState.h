@@ -7,6 +7,8 @@
 #include "Tasks/TargetingFilterTask_BasicFilterTemplate.h"
 #include "DoorFilter_DoorState.generated.h"
 
+class ADoor;
+
 UENUM(BlueprintType)
 enum class EDoorFilterType : uint8
 {
@@ -60,29 +62,65 @@ public:
 	UPROPERTY(EditAnywhere, Category="Door Filter", meta=(EditCondition="DoorOpenDirectionFilterType!=EDoorFilterType::Ignore", EditConditionHides))
 	TArray<EDoorOpenDirection> DoorOpenDirections = { EDoorOpenDirection::Bidirectional, EDoorOpenDirection::Inward, EDoorOpenDirection::Outward, EDoorOpenDirection::Locked };
 	
+protected:
+	/**
+	 * Filter lists compiled into one bit per enum value, see GetDoorFilterBits()
+	 * A door is filtered if any of its bits are not allowed
+	 */
+	uint16 AllowedDoorFilterBits = MAX_uint16;
+	
 public:
 	UDoorFilter_DoorState(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
+	virtual void PostInitProperties() override;
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/** Compile the filter lists into AllowedDoorFilterBits */
+	void CompileDoorFilter();
+
+	/**
+	 * One bit each for the door's state (0-3), direction (4-5), access (6-8) and open direction (9-12)
+	 */
+	static uint16 GetDoorFilterBits(const ADoor* Door);
+
 protected:
+	/** Filters every target in a single pass, the source context is only found once */
+	virtual void Execute(const FTargetingRequestHandle& TargetingHandle) const override;
+	
 	/** Called against every target data to determine if the target should be filtered out */
 	virtual bool ShouldFilterTarget(const FTargetingRequestHandle& TargetingHandle, const FTargetingDefaultResultData& TargetData) const override;
 
-	// Helper for filtering values based on filter type
+	/** @return True if the target should be filtered out, once we know the source context is valid */
+	bool ShouldFilterDoorTarget(const FTargetingDefaultResultData& TargetData) const;
+
+	// Helper for compiling a filter list into the allowed bits for its enum
 	template<typename T>
-	bool IsValueFiltered(EDoorFilterType FilterType, T Value, const TArray<T>& FilterList) const;
+	static uint16 CompileFilterList(EDoorFilterType FilterType, const TArray<T>& FilterList, int32 NumValues, int32 Offset);
 };
 
 template <typename T>
-bool UDoorFilter_DoorState::IsValueFiltered(EDoorFilterType FilterType, T Value, const TArray<T>& FilterList) const
+uint16 UDoorFilter_DoorState::CompileFilterList(EDoorFilterType FilterType, const TArray<T>& FilterList, int32 NumValues, int32 Offset)
 {
+	const uint16 AllValues = static_cast<uint16>(((1 << NumValues) - 1) << Offset);
+	
+	uint16 Listed = 0;
+	for (const T Value : FilterList)
+	{
+		Listed |= static_cast<uint16>(1 << (static_cast<int32>(Value) + Offset));
+	}
+	
 	switch (FilterType)
 	{
 	case EDoorFilterType::Whitelist:
-		return !FilterList.Contains(Value);
+		return Listed & AllValues;
 	case EDoorFilterType::Blacklist:
-		return FilterList.Contains(Value);
+		return ~Listed & AllValues;
 	case EDoorFilterType::Ignore:
 	default:
-		return false;
+		return AllValues;
 	}
 }
@@ -0,0 +1,41 @@
+﻿// Copyright (c) Jared Taylor
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/TargetingTask.h"
+#include "DoorSelection_SpatialIndex.generated.h"
+
+/**
+ * Select doors within reach and view of the source actor from the door spatial index
+ * Replaces collision based selection for door-only interaction requests, no physics queries are made
+ * Results are emitted nearest door first, one per graspable component, doors without graspable components are skipped
+ */
+UCLASS(Blueprintable, DisplayName="Door Selection (Spatial Index)")
+class DOORS_API UDoorSelection_SpatialIndex : public UTargetingTask
+{
+	GENERATED_BODY()
+
+public:
+	/** How far from the source actor's view location doors can be selected */
+	UPROPERTY(EditAnywhere, Category="Door Selection", meta=(ClampMin="0", UIMin="0", UIMax="1000", Delta="10", ForceUnits="cm"))
+	float Reach = 250.f;
+
+	/** Half angle of the view cone, doors outside of it are not selected */
+	UPROPERTY(EditAnywhere, Category="Door Selection", meta=(ClampMin="0", UIMin="0", ClampMax="180", UIMax="180", Delta="1", ForceUnits="degrees"))
+	float ViewConeHalfAngle = 60.f;
+
+	/** Doors closer than this are selected regardless of the view cone, e.g. when standing in the doorway */
+	UPROPERTY(EditAnywhere, Category="Door Selection", meta=(ClampMin="0", UIMin="0", UIMax="200", Delta="5", ForceUnits="cm"))
+	float IgnoreViewConeDistance = 50.f;
+
+	/** Maximum number of doors to select */
+	UPROPERTY(EditAnywhere, Category="Door Selection", meta=(ClampMin="1", UIMin="1", UIMax="16"))
+	int32 MaxTargets = 4;
+
+public:
+	UDoorSelection_SpatialIndex(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+protected:
+	virtual void Execute(const FTargetingRequestHandle& TargetingHandle) const override;
+};
@@ -0,0 +1,20 @@
+﻿// Copyright (c) Jared Taylor
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavAreas/NavArea.h"
+#include "DoorNavArea_Closed.generated.h"
+
+/**
+ * Nav link area for a door that is closed but can be opened by the agent
+ * Costs more than an open door because the agent must stop and open it
+ */
+UCLASS(Config=Engine)
+class DOORS_API UDoorNavArea_Closed : public UNavArea
+{
+	GENERATED_BODY()
+
+public:
+	UDoorNavArea_Closed(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+};
@@ -0,0 +1,66 @@
+﻿// Copyright (c) Jared Taylor
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DoorTypes.h"
+#include "NavLinkCustomComponent.h"
+#include "DoorNavLinkComponent.generated.h"
+
+class ADoor;
+
+/**
+ * One-way navigation link through a door, from FromSide to the opposite side
+ * ADoor owns one for each side so that access restrictions such as EDoorAccess::Front can be represented
+ *
+ * Door changes only swap the link's area, which updates the existing off-mesh connection in place without
+ * rebuilding navmesh tiles. The doorway itself must be cut from the navmesh, e.g. by the door's collision or a
+ * NavArea_Null modifier, so that agents are forced through the links
+ *
+ * Agents that start using the link are queued with UDoorTraversalSubsystem, which holds them until it has opened the
+ * door for them
+ */
+UCLASS(ClassGroup=(Door), meta=(BlueprintSpawnableComponent))
+class DOORS_API UDoorNavLinkComponent : public UNavLinkCustomComponent
+{
+	GENERATED_BODY()
+
+public:
+	/** Agents using this link start on this side of the door and end on the other side */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Navigation)
+	EDoorSide FromSide = EDoorSide::Front;
+
+	/** Distance from the door to each end of the link */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Navigation, meta=(ClampMin="1", UIMin="1", UIMax="500", Delta="5", ForceUnits="cm"))
+	float LinkDistance = 100.f;
+
+	/** Area used while the door is open or opening */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Navigation)
+	TSubclassOf<UNavArea> OpenAreaClass;
+
+	/** Area used while the door is closed or closing, but can be opened from FromSide */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Navigation)
+	TSubclassOf<UNavArea> ClosedAreaClass;
+
+public:
+	UDoorNavLinkComponent(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+	/**
+	 * Update the link's passability and cost from the door's state, access and open direction
+	 * Does nothing if neither has changed, so this is cheap enough to call on any door change
+	 */
+	void UpdateFromDoor(const ADoor* Door);
+
+	/** Queue the agent to pass through the door, pausing its move until the door is open */
+	virtual bool OnLinkMoveStarted(UObject* PathComp, const FVector& DestPoint) override;
+
+protected:
+	virtual void OnRegister() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/** Place the link across the door from FromSide, in the owning door's space */
+	void UpdateLinkPoints();
+};
@@ -0,0 +1,41 @@
+﻿// Copyright (c) Jared Taylor
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Volume.h"
+#include "DoorRoomVolume.generated.h"
+
+/**
+ * Defines a room for the door portal graph, doors between rooms become portals between them
+ * Rooms are treated as the oriented bounding box of the volume's brush, so box brushes are recommended
+ * Anything not inside a room is considered outside, which is never culled
+ * @see UDoorPortalSubsystem
+ */
+UCLASS()
+class DOORS_API ADoorRoomVolume : public AVolume
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * If true, static primitives in this room are hidden when no open door leads to it from the camera's room
+	 * Disable for rooms that can be seen into without a door, e.g. through windows
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Room)
+	bool bCullWhenNotVisible = true;
+
+public:
+	ADoorRoomVolume(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	/** The transform the room's bounds are relative to */
+	FTransform GetRoomTransform() const;
+
+	/** The room's bounds in the space of GetRoomTransform() */
+	FBox GetRoomLocalBounds() const;
+};
@@ -0,0 +1,195 @@
+﻿// Copyright (c) Jared Taylor
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Chaos/SimCallbackInput.h"
+#include "Chaos/SimCallbackObject.h"
+#include "Engine/EngineTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DoorAsyncPhysicsSubsystem.generated.h"
+
+class ADoor;
+class UPrimitiveComponent;
+
+namespace Chaos
+{
+	class FSingleParticlePhysicsProxy;
+}
+
+/**
+ * How the door leaf moves with alpha, relative to its attach parent
+ * Shared by the physics thread and game thread so both place the leaf identically
+ */
+struct FDoorLeafMotion
+{
+	/** Leaf relative transform when closed */
+	FTransform ClosedRelative = FTransform::Identity;
+
+	/** Added to the leaf's rotation and location at alpha 1, and subtracted at alpha -1 */
+	FRotator OpenRotation = FRotator::ZeroRotator;
+	FVector OpenOffset = FVector::ZeroVector;
+
+	FTransform GetRelativeTransform(float Alpha) const
+	{
+		return FTransform((OpenRotation * Alpha).Quaternion() * ClosedRelative.GetRotation(),
+			ClosedRelative.GetLocation() + OpenOffset * Alpha, ClosedRelative.GetScale3D());
+	}
+};
+
+/**
+ * A change to a door, sent from the game thread to the physics thread
+ * Inputs can be consumed by several physics steps, commands are only applied once per revision
+ */
+struct FDoorAsyncPhysicsCommand
+{
+	int32 Id = INDEX_NONE;
+	uint32 Revision = 0;
+	bool bRemove = false;
+
+	/** True to overwrite the physics thread's alpha, e.g. when stationary, otherwise it continues from where it is */
+	bool bSetAlpha = false;
+
+	Chaos::FSingleParticlePhysicsProxy* Proxy = nullptr;
+	FTransform ParentTransform = FTransform::Identity;
+	FDoorLeafMotion Motion;
+	float Alpha = 0.f;
+	float TargetAlpha = 0.f;
+
+	/** Alpha per second toward the target */
+	float Rate = 0.f;
+};
+
+struct FDoorAsyncPhysicsInput : public Chaos::FSimCallbackInput
+{
+	TArray<FDoorAsyncPhysicsCommand> Commands;
+
+	void Reset()
+	{
+		Commands.Reset();
+	}
+};
+
+struct FDoorAsyncPhysicsOutput : public Chaos::FSimCallbackOutput
+{
+	/** Door id and alpha, for doors whose alpha changed this step */
+	TArray<TPair<int32, float>> Alphas;
+
+	void Reset()
+	{
+		Alphas.Reset();
+	}
+};
+
+/**
+ * Integrates door alpha and sets each leaf's kinematic target at the start of every physics step
+ */
+class DOORS_API FDoorAsyncPhysicsCallback : public Chaos::TSimCallbackObject<FDoorAsyncPhysicsInput, FDoorAsyncPhysicsOutput>
+{
+protected:
+	struct FDoor
+	{
+		uint32 Revision = 0;
+		Chaos::FSingleParticlePhysicsProxy* Proxy = nullptr;
+		FTransform ParentTransform = FTransform::Identity;
+		FDoorLeafMotion Motion;
+		float Alpha = 0.f;
+		float TargetAlpha = 0.f;
+		float Rate = 0.f;
+
+		/** The leaf needs placing even though the alpha is at its target, e.g. after the alpha was overwritten */
+		bool bDirty = false;
+	};
+
+	/** Physics thread only */
+	TMap<int32, FDoor> Doors;
+
+	virtual void OnPreSimulate_Internal() override;
+};
+
+/**
+ * Runs door motion in the physics step instead of the door's tick, for doors with bAsyncDoorMotion
+ *
+ * The game thread sends state changes to FDoorAsyncPhysicsCallback, which integrates alpha at the physics step
+ * and moves each leaf with a kinematic target, so leaves collide the same regardless of frame rate
+ * Alphas are marshalled back and applied to the doors and their leaves on the game thread, which fires the usual events
+ * Enable async physics in the project settings for a fixed step, otherwise the step follows the frame
+ *
+ * The physics thread only holds a leaf's proxy while its body exists, if the leaf's physics state is destroyed the
+ * door is suspended and moves on its own tick until the body is recreated
+ */
+UCLASS()
+class DOORS_API UDoorAsyncPhysicsSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	struct FDoorEntry
+	{
+		TWeakObjectPtr<ADoor> Door;
+		TWeakObjectPtr<UPrimitiveComponent> Leaf;
+		FDoorLeafMotion Motion;
+
+		/** The leaf has no physics body, the physics thread has forgotten the door and the door ticks itself */
+		bool bSuspended = false;
+	};
+
+	FDoorAsyncPhysicsCallback* Callback = nullptr;
+
+	TMap<TObjectKey<ADoor>, int32> DoorIds;
+	TMap<int32, FDoorEntry> Doors;
+
+	/** Commands for the next input, sent on tick */
+	TArray<FDoorAsyncPhysicsCommand> PendingCommands;
+
+	/** Newest alpha for each door across every step since the last tick */
+	TMap<int32, float> LatestAlphas;
+
+	int32 NextId = 0;
+	uint32 NextRevision = 0;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override;
+
+public:
+	/**
+	 * Move the door in the physics step, the leaf's current pose is its closed pose
+	 * @return False if the door has no leaf with a physics body, it should move on its own tick
+	 */
+	bool RegisterDoor(ADoor* Door);
+	void UnregisterDoor(ADoor* Door);
+
+	/** Send the door's target and rate to the physics thread, call when the door state, transform or doorway hold changes */
+	void UpdateDoor(ADoor* Door);
+
+protected:
+	/** Build a command with the door's current target, rate and leaf */
+	bool MakeCommand(const ADoor* Door, int32 Id, const FDoorLeafMotion& Motion, FDoorAsyncPhysicsCommand& OutCommand);
+
+	/** Place the leaf on the game thread without moving its physics body, the physics thread already moved it */
+	static void MoveLeaf(UPrimitiveComponent* Leaf, const FDoorLeafMotion& Motion, float Alpha);
+
+	/**
+	 * Remove the door from the physics thread in the current input rather than on tick
+	 * Its proxy may be destroyed before we tick, so it must never be seen by a step after that
+	 */
+	void SendRemove(int32 Id);
+
+	/** Forget the proxy when the leaf's body is destroyed, and resume with the new proxy when it is recreated */
+	UFUNCTION()
+	void OnLeafPhysicsStateChanged(UPrimitiveComponent* ChangedComponent, EComponentPhysicsStateChange StateChange);
+
+	/** Place the leaves of suspended doors, which move on their own tick */
+	void MoveSuspendedLeaves();
+
+	void ConsumeOutputs();
+	void SendCommands();
+};
@@ -0,0 +1,111 @@
+﻿// Copyright (c) Jared Taylor
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DoorTypes.h"
+
+/** Fixed-point door alpha, DoorFixedOne is an alpha of 1 */
+static constexpr int32 DoorFixedShift = 16;
+static constexpr int32 DoorFixedOne = 1 << DoorFixedShift;
+
+/** Easing tables have 2^DoorFixedEaseBits segments */
+static constexpr int32 DoorFixedEaseBits = 6;
+static constexpr int32 DoorFixedEaseSegments = 1 << DoorFixedEaseBits;
+
+/**
+ * Piecewise linear easing curve in fixed point, evaluated with integer math only
+ */
+struct DOORS_API FDoorFixedEaseTable
+{
+	/** Eased value at each segment boundary, from 0 to DoorFixedOne */
+	TStaticArray<int32, DoorFixedEaseSegments + 1> Values;
+
+	/** @param Phase Linear progress from 0 to DoorFixedOne */
+	int32 Evaluate(int32 Phase) const;
+
+	static FDoorFixedEaseTable MakeLinear();
+
+	/** 3x^2 - 2x^3, built with integer math so every machine builds the same table */
+	static FDoorFixedEaseTable MakeSmoothStep();
+
+	static FDoorFixedEaseTable Make(EDoorEasing Easing);
+};
+
+/**
+ * Door times in whole ticks, build these once from the door's properties
+ */
+struct DOORS_API FDoorFixedSimParams
+{
+	/** Ticks to fully open or close, indexed by EDoorDirection */
+	int32 OpenTicks[2] = { 30, 30 };
+	int32 CloseTicks[2] = { 30, 30 };
+
+	FDoorFixedEaseTable Ease = FDoorFixedEaseTable::MakeLinear();
+
+	static FDoorFixedSimParams Make(float OpenOutwardTime, float OpenInwardTime, float CloseOutwardTime, float CloseInwardTime,
+		int32 TicksPerSecond, EDoorEasing Easing);
+};
+
+/**
+ * Complete state of the simulation, copy it to snapshot for rollback
+ */
+struct DOORS_API FDoorFixedSimState
+{
+	uint32 Tick = 0;
+
+	/** Linear progress before easing, DoorFixedOne is fully open outward and -DoorFixedOne fully open inward */
+	int32 Phase = 0;
+
+	EDoorState DoorState = EDoorState::Closed;
+	EDoorDirection DoorDirection = EDoorDirection::Outward;
+
+	bool operator==(const FDoorFixedSimState& Other) const
+	{
+		return Tick == Other.Tick && Phase == Other.Phase && DoorState == Other.DoorState && DoorDirection == Other.DoorDirection;
+	}
+	bool operator!=(const FDoorFixedSimState& Other) const { return !(*this == Other); }
+};
+
+/**
+ * Deterministic door simulation for replays and rollback
+ * Integer ticks, fixed-point phase and table easing, with state transitions at exact phase values rather than tolerances
+ * Identical params and inputs on identical ticks produce bit-identical states and alphas on every machine and build
+ */
+struct DOORS_API FDoorFixedSim
+{
+	FDoorFixedSimParams Params;
+	FDoorFixedSimState State;
+
+	/** Apply a door state change, takes effect from the next Step() -- Open and Closed snap to the end */
+	void ApplyInput(EDoorState NewDoorState, EDoorDirection NewDoorDirection);
+
+	/** Advance one tick, Opening and Closing become Open and Closed when the phase reaches the end */
+	void Step();
+
+	/** Eased alpha in fixed point */
+	int32 GetAlpha() const;
+
+	/** Steps until the current motion reaches its end, 0 if stationary */
+	int32 GetRemainingTicks() const;
+
+	/** Fold the state and alpha into a running hash, for comparing traces between machines and builds */
+	uint32 HashState(uint32 Hash) const;
+
+	/** Exact, every fixed-point alpha is representable as a float */
+	static float ToFloat(int32 Fixed) { return static_cast<float>(Fixed) / static_cast<float>(DoorFixedOne); }
+	static int32 FromFloat(float Value) { return FMath::RoundToInt32(FMath::Clamp<float>(Value, -1.f, 1.f) * DoorFixedOne); }
+
+	/**
+	 * Simulate a fixed input script, including a reversal and a change of direction mid-motion, and hash its trace
+	 * Logged by p.Door.Fixed.TraceHash, and checked against golden hashes by the Doors.FixedSim.TraceHash test
+	 */
+	static uint32 HashTraceScript(EDoorEasing Easing);
+
+	/** Ticks per second, p.Door.Fixed.TickRate -- must match on every machine */
+	static int32 GetTicksPerSecond();
+
+protected:
+	/** @return False if stationary, otherwise the phase the motion ends at and how far each step moves toward it */
+	bool GetMotion(int32& OutTarget, int32& OutStepSize) const;
+};
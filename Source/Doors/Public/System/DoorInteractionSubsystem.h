@@ -0,0 +1,72 @@
+﻿// Copyright (c) Jared Taylor
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DoorInteractionSubsystem.generated.h"
+
+class ADoor;
+
+/**
+ * Token bucket that limits how often an avatar can interact with doors
+ */
+struct FDoorInteractionBucket
+{
+	float Tokens = 0.f;
+	float LastRefillTime = -1.f;
+};
+
+/**
+ * The interaction that won a door this frame
+ */
+struct FDoorInteractionClaim
+{
+	uint64 Frame = 0;
+	TWeakObjectPtr<const AActor> Avatar;
+};
+
+/**
+ * Server-side arbitration of door interactions
+ * 
+ * Each avatar has a token bucket that drops spammed interactions before any door logic runs
+ * Each door accepts a single avatar per frame, the first valid interaction to arrive wins and
+ * any other avatar interacting with the same door on the same frame is rejected without evaluation
+ */
+UCLASS()
+class DOORS_API UDoorInteractionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	TMap<TWeakObjectPtr<const AActor>, FDoorInteractionBucket> AvatarBuckets;
+	TMap<TWeakObjectPtr<const ADoor>, FDoorInteractionClaim> DoorClaims;
+
+	float LastPruneTime = -1.f;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+	virtual void Deinitialize() override;
+
+public:
+	/** @return True if another avatar already won an interaction with this door on this frame */
+	bool IsDoorContested(const ADoor* Door, const AActor* Avatar) const;
+
+	/** @return True if this avatar already won an interaction with this door on this frame */
+	bool HasClaimedDoor(const ADoor* Door, const AActor* Avatar) const;
+
+	/**
+	 * Consume a token from the avatar's bucket
+	 * @return False if the avatar is interacting too frequently and the interaction should be dropped
+	 */
+	bool ConsumeInteractionToken(const AActor* Avatar);
+
+	/** Record that the avatar won the interaction with this door on this frame */
+	void ClaimDoor(const ADoor* Door, const AActor* Avatar);
+
+protected:
+	/** Remove buckets and claims that are no longer relevant */
+	void PruneStaleEntries(float TimeSeconds);
+};
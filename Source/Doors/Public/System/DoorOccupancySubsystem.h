@@ -0,0 +1,85 @@
+﻿// Copyright (c) Jared Taylor
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DoorOccupancySubsystem.generated.h"
+
+class ADoor;
+class APawn;
+
+/**
+ * A pawn bucketed into the occupancy grid for the current frame
+ */
+struct FDoorOccupant
+{
+	/** Occupants are kept until the grid is rebuilt, which may be frames later, the pawn may be destroyed by then */
+	TWeakObjectPtr<APawn> Pawn;
+	FVector Location = FVector::ZeroVector;
+	float Radius = 0.f;
+	float HalfHeight = 0.f;
+};
+
+/**
+ * Central doorway occupancy for doors that shouldn't close on pawns, replacing per-door overlap volumes and sweeps
+ *
+ * Every pawn is bucketed into a 2D grid at most once per frame, and only on frames where a door asks
+ * Doors then test the few pawns in the cells around their doorway, so checking every closing door every frame is cheap
+ */
+UCLASS()
+class DOORS_API UDoorOccupancySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	/** Every pawn in the world, pawns that no longer exist are removed when the grid is built */
+	TArray<TWeakObjectPtr<APawn>> Pawns;
+
+	/** Pawns for the frame the grid was built */
+	TArray<FDoorOccupant> Occupants;
+
+	/** Occupant indices in each cell, keyed by the pawn's location */
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<8>>> Cells;
+
+	float CellSize = 500.f;
+
+	/** Doorways are expanded by the largest pawn so pawns only need to be in a single cell */
+	float MaxOccupantRadius = 0.f;
+	
+	uint64 BuiltFrame = MAX_uint64;
+
+	FDelegateHandle ActorSpawnedHandle;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+public:
+	/** @return True if any pawn that can block the door is inside its doorway */
+	bool IsDoorwayOccupied(const ADoor* Door);
+
+	/** Pawns that can block the door inside its doorway */
+	int32 GetDoorwayOccupants(const ADoor* Door, TArray<APawn*>& OutPawns);
+
+protected:
+	FIntPoint GetCell(const FVector& Location) const
+	{
+		return { FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize) };
+	}
+
+	void OnActorSpawned(AActor* Actor);
+
+	/** Bucket every pawn into the grid, does nothing if the grid was already built this frame */
+	void UpdateOccupants();
+
+	/**
+	 * Call Func(APawn* Pawn) for every pawn in the door's doorway that can block it, until Func returns false
+	 * @return False if Func stopped the iteration
+	 */
+	template<typename FuncType>
+	bool ForEachOccupant(const ADoor* Door, FuncType&& Func);
+};
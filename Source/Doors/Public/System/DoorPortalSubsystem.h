@@ -0,0 +1,289 @@
+﻿// Copyright (c) Jared Taylor
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DoorTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DoorPortalSubsystem.generated.h"
+
+class ADoor;
+class ADoorRoomVolume;
+class APlayerController;
+
+/** Index of the room that contains everything not inside a room volume, it always exists and is never culled */
+static constexpr int32 DoorPortalOutside = 0;
+
+/**
+ * A room in the portal graph, an oriented box
+ */
+struct DOORS_API FDoorPortalRoom
+{
+	FTransform Transform = FTransform::Identity;
+	FBox LocalBounds = FBox(ForceInit);
+
+	/** Portals that lead into or out of this room */
+	TArray<int32, TInlineAllocator<4>> Portals;
+
+	/** If false the room's contents are never culled */
+	bool bCullable = true;
+	bool bValid = false;
+
+	bool Contains(const FVector& Location) const
+	{
+		return LocalBounds.IsInside(Transform.InverseTransformPosition(Location));
+	}
+
+	/** @return True if the whole box is inside the room, rooms are convex so testing the corners is enough */
+	bool ContainsBox(const FBox& Box) const
+	{
+		FVector Corners[8];
+		Box.GetVertices(Corners);
+		for (const FVector& Corner : Corners)
+		{
+			if (!Contains(Corner))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+/**
+ * A door in the portal graph, connecting the room in front of it to the room behind it
+ */
+struct DOORS_API FDoorPortal
+{
+	TWeakObjectPtr<ADoor> Door;
+
+	/** Room on each EDoorSide of the door */
+	int32 Rooms[2] = { DoorPortalOutside, DoorPortalOutside };
+
+	/** Absolute door alpha, 0 when closed and 1 when fully open, in steps of p.Door.Propagation.OpennessSteps */
+	float Openness = 0.f;
+
+	/** True unless the door is fully closed */
+	bool bOpen = false;
+	bool bValid = false;
+
+	int32 GetOtherRoom(int32 Room) const { return Rooms[0] == Room ? Rooms[1] : Rooms[0]; }
+};
+
+/**
+ * Room and portal connectivity, plain data with no dependency on the world so it can be built and queried headless
+ */
+struct DOORS_API FDoorPortalGraph
+{
+	FDoorPortalGraph();
+
+	/** Rooms are never moved, removed rooms are reused -- DoorPortalOutside is always valid */
+	TArray<FDoorPortalRoom> Rooms;
+	TArray<int32> FreeRooms;
+
+	/** Portals are never moved, removed portals are reused */
+	TArray<FDoorPortal> Portals;
+	TArray<int32> FreePortals;
+
+	int32 AddRoom(const FTransform& Transform, const FBox& LocalBounds, bool bCullable);
+	void RemoveRoom(int32 Room);
+
+	int32 AddPortal(ADoor* Door, int32 FrontRoom, int32 BackRoom);
+	void RemovePortal(int32 Portal);
+
+	/** Connect the portal to different rooms, e.g. after rooms are added or removed */
+	void SetPortalRooms(int32 Portal, int32 FrontRoom, int32 BackRoom);
+
+	/** @return True if the portal opened or closed */
+	bool SetPortalOpenness(int32 Portal, float Openness, bool bOpen);
+
+	/**
+	 * The room that contains the location, DoorPortalOutside if none do
+	 * @param HintRoom Tested first, e.g. the room the location was in last time
+	 */
+	int32 FindRoom(const FVector& Location, int32 HintRoom = INDEX_NONE) const;
+
+	/** The room that contains the whole box, DoorPortalOutside if none do or the box crosses a room boundary */
+	int32 FindRoomContainingBox(const FBox& Box) const;
+
+	/** Walk open portals from the start room, setting the bit for each room that is reached */
+	void ComputeVisibleRooms(int32 StartRoom, TBitArray<>& OutVisibleRooms) const;
+};
+
+/**
+ * Best propagation from a source room to every other room, through the doors between them
+ */
+struct DOORS_API FDoorPropagationTree
+{
+	/** FDoorPropagationCache::Generation this was computed at, 0 if never computed */
+	uint32 Generation = 0;
+
+	/** Fraction that reaches each room, 1 in the source room and 0 in unreachable rooms */
+	TArray<float> Transmission;
+
+	/** The portal each room is reached through on the best path, INDEX_NONE for the source room and unreachable rooms */
+	TArray<int32> ViaPortal;
+};
+
+/**
+ * Door propagation between rooms, computed lazily per source room and reused until a door it can reach changes
+ * Following ViaPortal back to the source gives the doors along the best path in O(path length)
+ */
+struct DOORS_API FDoorPropagationCache
+{
+	/** Trees for each EDoorPropagation, indexed by source room */
+	TArray<FDoorPropagationTree> Trees[2];
+
+	/** Incremented whenever a portal or room changes, trees from a previous generation are recomputed on demand */
+	uint32 Generation = 1;
+
+	void Invalidate() { Generation++; }
+
+	/**
+	 * Invalidate only the trees the portal can affect, call when its openness changes but its rooms don't
+	 * A tree that reaches neither of the portal's rooms has no path through it, so it stays valid
+	 */
+	void InvalidatePortal(const FDoorPortalGraph& Graph, int32 Portal);
+
+	/**
+	 * How much passes through the portal
+	 * @param ClosedSoundTransmission Fraction of sound that passes through a fully closed door
+	 */
+	static float GetPortalTransmission(const FDoorPortal& Portal, EDoorPropagation Propagation, float ClosedSoundTransmission);
+
+	/** Best propagation from the source room, recomputed if the graph changed since it was last used */
+	const FDoorPropagationTree& GetTree(const FDoorPortalGraph& Graph, int32 SourceRoom, EDoorPropagation Propagation,
+		float ClosedSoundTransmission);
+};
+
+/**
+ * Visibility of each room from a local player's camera
+ */
+struct FDoorPortalView
+{
+	int32 CameraRoom = DoorPortalOutside;
+	TBitArray<> VisibleRooms;
+
+	/** Primitives we added to the player controller's HiddenPrimitiveComponents */
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> HiddenPrimitives;
+};
+
+/**
+ * Room/portal graph built from ADoorRoomVolume placements, with every door as a portal between the rooms on either side
+ * of it. A portal walk from the camera's room produces the visible set, and static primitives in rooms that can't be
+ * seen are hidden from that player's view so the renderer doesn't pay for them, including occlusion queries
+ *
+ * The graph is updated incrementally as doors open and close, the visible set is only recomputed when a portal opens or
+ * closes or the camera changes rooms
+ *
+ * The same graph answers propagation queries for audio and AI perception, e.g. how muffled a sound is or whether line
+ * of sight is blocked by the doors between two locations, without traces. Culling is skipped on dedicated servers
+ * but propagation is available everywhere
+ */
+UCLASS()
+class DOORS_API UDoorPortalSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	FDoorPortalGraph Graph;
+	TMap<TObjectKey<ADoor>, int32> DoorPortals;
+	TMap<TObjectKey<ADoorRoomVolume>, int32> VolumeRooms;
+
+	/** Room volume for each room, indexed by room */
+	TArray<TWeakObjectPtr<ADoorRoomVolume>> RoomVolumes;
+
+	/** Static primitives in each room, indexed by room */
+	TArray<TArray<TWeakObjectPtr<UPrimitiveComponent>>> RoomPrimitives;
+
+	TMap<TWeakObjectPtr<APlayerController>, FDoorPortalView> Views;
+
+	mutable FDoorPropagationCache PropagationCache;
+
+	bool bRoomPrimitivesDirty = true;
+	bool bVisibilityDirty = true;
+
+	FDelegateHandle LevelAddedHandle;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override;
+
+public:
+	void RegisterRoom(ADoorRoomVolume* Room);
+	void UnregisterRoom(ADoorRoomVolume* Room);
+
+	void RegisterDoor(ADoor* Door);
+	void UnregisterDoor(ADoor* Door);
+
+	/** Refresh the portal's openness from the door, call when the door state or alpha changes */
+	void UpdateDoor(const ADoor* Door);
+
+	/** Reconnect the portal to the rooms either side of the door, call when the door moves */
+	void UpdateDoorRooms(const ADoor* Door);
+
+	const FDoorPortalGraph& GetGraph() const { return Graph; }
+
+	/** Rooms that can be seen from the location through open doors, does not require a player */
+	void GetVisibleRooms(const FVector& ViewLocation, TArray<ADoorRoomVolume*>& OutRooms) const;
+
+	/** The room volume that contains the location, nullptr if outside */
+	ADoorRoomVolume* GetRoomAtLocation(const FVector& Location) const;
+
+	/**
+	 * Fraction of sound or sight that passes through the doors between two locations, following the best path
+	 * 1 if both are in the same room, 0 if no path exists
+	 * Each door transmits in proportion to its alpha, a closed door transmits p.Door.Propagation.ClosedSoundTransmission
+	 * of sound and no sight
+	 */
+	UFUNCTION(BlueprintCallable, Category=Door)
+	float GetDoorTransmission(const FVector& From, const FVector& To, EDoorPropagation Propagation) const;
+
+	/** Sound occlusion between two locations due to doors, 0 is unoccluded and 1 is fully occluded */
+	UFUNCTION(BlueprintCallable, Category=Door)
+	float GetDoorSoundOcclusion(const FVector& SourceLocation, const FVector& ListenerLocation) const
+	{
+		return 1.f - GetDoorTransmission(SourceLocation, ListenerLocation, EDoorPropagation::Sound);
+	}
+
+	/**
+	 * True if closed doors block line of sight between two locations
+	 * Walls are not considered, use from IAISightTargetInterface::CanBeSeenFrom() to reject targets before tracing
+	 */
+	UFUNCTION(BlueprintCallable, Category=Door)
+	bool IsSightBlockedByDoors(const FVector& ViewerLocation, const FVector& TargetLocation) const
+	{
+		return GetDoorTransmission(ViewerLocation, TargetLocation, EDoorPropagation::Sight) <= 0.f;
+	}
+
+	/**
+	 * The doors along the best propagation path between two locations, nearest to From first
+	 * @return The fraction that passes through, same as GetDoorTransmission()
+	 */
+	float GetDoorPropagationPath(const FVector& From, const FVector& To, EDoorPropagation Propagation, TArray<ADoor*>& OutDoors) const;
+
+protected:
+	/** Find the rooms either side of the door */
+	void ProbeDoorRooms(const ADoor* Door, int32& OutFrontRoom, int32& OutBackRoom) const;
+
+	/** Reconnect every portal, after rooms are added or removed */
+	void ReprobeAllPortals();
+	
+	/** Assign static primitives to the room that contains them */
+	void GatherRoomPrimitives();
+
+	void OnLevelAddedToWorld(ULevel* Level, UWorld* World);
+
+	/** Update the player's hidden primitives to match the visible rooms */
+	void ApplyView(APlayerController* PlayerController, FDoorPortalView& View, const TBitArray<>& NewVisibleRooms);
+
+	/** Remove every primitive we hid from the player's view */
+	void ClearView(APlayerController* PlayerController, FDoorPortalView& View);
+};
@@ -0,0 +1,114 @@
+﻿// Copyright (c) Jared Taylor
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DoorProximitySubsystem.generated.h"
+
+class ADoor;
+class APawn;
+
+/**
+ * An automatic door registered with the proximity system
+ */
+struct FDoorProximityEntry
+{
+	TWeakObjectPtr<ADoor> Door;
+
+	/** Door space, without scale, the trigger is centered on GetDoorLocation() */
+	FTransform Transform = FTransform::Identity;
+	FVector Extent = FVector::ZeroVector;
+	float Hysteresis = 0.f;
+
+	/** Cells the trigger overlaps, including hysteresis */
+	TArray<FIntPoint, TInlineAllocator<4>> Cells;
+
+	/** True while any pawn was inside the trigger at the last update */
+	bool bOccupied = false;
+
+	/** Last time a pawn was inside the trigger */
+	float LastOccupiedTime = -1.f;
+
+	/** Client only, when we opened the door locally ahead of the server, or -1 once the server agrees or we gave up */
+	float PredictedOpenTime = -1.f;
+
+	bool bValid = false;
+};
+
+/**
+ * Central proximity system for automatic doors, replacing per-door overlap volumes
+ * 
+ * Every pawn is tested against the triggers of registered auto doors in a 2D spatial hash at p.Door.Auto.UpdateRate
+ * Doors open when a pawn enters their trigger, and close once every pawn has left the trigger plus its hysteresis
+ * and the door's hold open time has elapsed
+ *
+ * Clients run the trigger for doors with bAutoDoorClientPredicted, testing only their locally controlled pawns
+ * The door opens locally without waiting for the server, then the server's replicated state takes over once it agrees
+ */
+UCLASS()
+class DOORS_API UDoorProximitySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	/** Entries are never moved, removed entries are reused */
+	TArray<FDoorProximityEntry> Entries;
+	TArray<int32> FreeEntries;
+	TMap<TObjectKey<ADoor>, int32> DoorEntries;
+
+	/** Entry indices whose trigger overlaps each cell */
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> Cells;
+
+	/** Every pawn in the world, pawns that no longer exist are removed on update */
+	TArray<TWeakObjectPtr<APawn>> Pawns;
+
+	float CellSize = 500.f;
+	float LastUpdateTime = -1.f;
+
+	FDelegateHandle ActorSpawnedHandle;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override;
+
+public:
+	void RegisterDoor(ADoor* Door);
+	void UnregisterDoor(ADoor* Door);
+
+	/** Refresh the door's trigger, call when the door moves or its trigger changes */
+	void UpdateDoor(ADoor* Door);
+
+	/** @return True if any pawn was inside the door's trigger at the last update */
+	bool IsAutoDoorOccupied(const ADoor* Door) const;
+
+	/** @return True if we opened the door locally and the server has not yet agreed */
+	bool IsAutoDoorPredicting(const ADoor* Door) const;
+
+protected:
+	FIntPoint GetCell(const FVector& Location) const
+	{
+		return { FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize) };
+	}
+
+	void AddToCells(int32 Index);
+	void RemoveFromCells(int32 Index);
+
+	void OnActorSpawned(AActor* Actor);
+
+	/** Test every pawn against nearby triggers, then open or close doors */
+	void UpdateProximity(float TimeSeconds);
+
+	/** Open or close the door based on whether it is occupied */
+	void UpdateAutoDoor(FDoorProximityEntry& Entry, APawn* OccupyingPawn, float TimeSeconds);
+
+	/** Client only, open the door when our pawn is occupying it and reconcile with the server */
+	void UpdatePredictedAutoDoor(FDoorProximityEntry& Entry, APawn* OccupyingPawn, float TimeSeconds);
+};
@@ -0,0 +1,79 @@
+﻿// Copyright (c) Jared Taylor
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DoorPushSubsystem.generated.h"
+
+class ADoor;
+class APawn;
+
+/**
+ * A moving door whose leaf pushes pawns out of its way
+ */
+struct FDoorPushEntry
+{
+	TWeakObjectPtr<ADoor> Door;
+
+	/** Key into DoorEntries, remains valid after the door is destroyed */
+	TObjectKey<ADoor> DoorKey;
+
+	/** Leaf bounds when the last query was issued, the swept volume covers the leaf's motion since */
+	FBox LastLeafBounds = FBox(ForceInit);
+
+	/** Overlap issued last frame, consumed this frame */
+	FTraceHandle PendingQuery;
+
+	bool bValid = false;
+};
+
+/**
+ * Pushes pawns out of the way of moving door leaves, replacing per-door sweeps on tick
+ *
+ * Every frame the swept volume of each moving door's leaf is issued as one batch of async overlaps against pawns
+ * Results are consumed the following frame, and only doors with a pawn in their path resolve the penetration
+ * Pawns are only resolved where their movement is owned, i.e. on the controlling client, or on the server for pawns
+ * no remote client controls -- the server receives player corrections through movement prediction rather than
+ * moving the pawn itself
+ */
+UCLASS()
+class DOORS_API UDoorPushSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	/** Entries are never moved, removed entries are reused */
+	TArray<FDoorPushEntry> Entries;
+	TArray<int32> FreeEntries;
+	TMap<TObjectKey<ADoor>, int32> DoorEntries;
+
+	/** Pawns found in the current door's path, reused between doors */
+	TArray<APawn*> ScratchPawns;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override;
+
+public:
+	/** Push pawns while the door is moving, the door is removed automatically once it is stationary */
+	void RegisterDoor(ADoor* Door);
+	void UnregisterDoor(ADoor* Door);
+
+protected:
+	/** Consume last frame's overlaps, resolving the doors that have pawns in their path */
+	void ConsumeQueries();
+
+	/** Issue overlaps for every moving door's swept leaf, removing doors that have stopped */
+	void IssueQueries();
+
+	/** Move each pawn out of the door's leaf */
+	void ResolvePush(ADoor* Door, UPrimitiveComponent* Leaf, const TArray<APawn*>& Pawns) const;
+};
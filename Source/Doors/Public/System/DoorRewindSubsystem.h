@@ -0,0 +1,112 @@
+﻿// Copyright (c) Jared Taylor
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DoorTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DoorRewindSubsystem.generated.h"
+
+class ADoor;
+
+/**
+ * Number of samples kept per tracked avatar or door -- this bounds the memory footprint of the rewind history
+ * p.Door.Rewind.SampleRate is clamped so that these samples always span p.Door.Rewind.MaxRewindTime
+ */
+static constexpr int32 DoorRewindMaxSamples = 32;
+
+/**
+ * Fixed capacity ring buffer of timestamped samples, oldest samples are overwritten
+ */
+template<typename T>
+struct TDoorRewindHistory
+{
+	TStaticArray<T, DoorRewindMaxSamples> Samples;
+	int32 Head = 0;
+	int32 Num = 0;
+
+	void Add(const T& Sample)
+	{
+		Head = (Head + 1) % DoorRewindMaxSamples;
+		Samples[Head] = Sample;
+		Num = FMath::Min(Num + 1, DoorRewindMaxSamples);
+	}
+
+	/** @return The sample that is Index samples older than the newest sample */
+	const T& GetFromNewest(int32 Index) const
+	{
+		return Samples[(Head - Index + DoorRewindMaxSamples) % DoorRewindMaxSamples];
+	}
+
+	bool IsEmpty() const { return Num == 0; }
+};
+
+struct FDoorRewindAvatarSample
+{
+	float Time = 0.f;
+	FVector Location = FVector::ZeroVector;
+};
+
+struct FDoorRewindDoorSample
+{
+	float Time = 0.f;
+	FVector Location = FVector::ZeroVector;
+	FVector Forward = FVector::ForwardVector;
+};
+
+/**
+ * Server-side lag compensation for validating the door side claimed by clients
+ * Records a short history of avatar locations and door transforms so the door side can be evaluated
+ * at the time the client interacted, rather than the time the server received the interaction
+ *
+ * Player pawns are tracked automatically, other avatars can be tracked with TrackAvatar()
+ * Doors that don't trust the client's door side register themselves
+ */
+UCLASS()
+class DOORS_API UDoorRewindSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	TMap<TWeakObjectPtr<const AActor>, TDoorRewindHistory<FDoorRewindAvatarSample>> AvatarHistory;
+	TMap<TWeakObjectPtr<const ADoor>, TDoorRewindHistory<FDoorRewindDoorSample>> DoorHistory;
+
+	/** Additional avatars to track that are not controlled by a player */
+	TArray<TWeakObjectPtr<const AActor>> TrackedAvatars;
+
+	float LastSampleTime = -1.f;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override;
+
+public:
+	/** Record history for an avatar that is not controlled by a player, e.g. AI */
+	void TrackAvatar(const AActor* Avatar);
+	void UntrackAvatar(const AActor* Avatar);
+
+	/** Record history for a door, required for doors that move or have a GetDoorLocation() that changes */
+	void RegisterDoor(const ADoor* Door);
+	void UnregisterDoor(const ADoor* Door);
+
+	/**
+	 * Evaluate the door side at a previous point in time
+	 * Falls back to the current location of the avatar or door if no history is available
+	 * @param Avatar The avatar interacting with the door
+	 * @param Door The door being interacted with
+	 * @param Timestamp Server world time to evaluate at, clamped to p.Door.Rewind.MaxRewindTime
+	 */
+	EDoorSide GetDoorSideAtTime(const AActor* Avatar, const ADoor* Door, float Timestamp) const;
+
+protected:
+	void RecordSamples(float TimeSeconds);
+
+	bool GetAvatarLocationAtTime(const AActor* Avatar, float Timestamp, FVector& OutLocation) const;
+	bool GetDoorSampleAtTime(const ADoor* Door, float Timestamp, FDoorRewindDoorSample& OutSample) const;
+};
@@ -0,0 +1,201 @@
+﻿// Copyright (c) Jared Taylor
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DoorTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DoorSpatialSubsystem.generated.h"
+
+class ADoor;
+struct FConvexVolume;
+
+/** Bitmask with a bit set for every door state, for filtering spatial queries by door state */
+static constexpr uint8 DoorSpatialAllStates = 0xF;
+
+/** @return Bitmask with the bit set for the door state, for filtering spatial queries by door state */
+static constexpr uint8 DoorSpatialStateMask(EDoorState State) { return static_cast<uint8>(1 << static_cast<uint8>(State)); }
+
+/**
+ * A door registered with the spatial index
+ * Only plain data is stored, so entries can be read from snapshots on worker threads
+ */
+struct DOORS_API FDoorSpatialEntry
+{
+	TWeakObjectPtr<ADoor> Door;
+	FVector Location = FVector::ZeroVector;
+	FIntPoint Cell = FIntPoint::ZeroValue;
+	EDoorState DoorState = EDoorState::Closed;
+	EDoorDirection DoorDirection = EDoorDirection::Outward;
+	bool bValid = false;
+};
+
+/**
+ * Uniform 2D grid of doors keyed by GetDoorLocation(), queries output entry indices into caller-owned arrays
+ * so they don't allocate once the caller's array has grown to fit
+ */
+struct DOORS_API FDoorSpatialIndex
+{
+	FDoorSpatialIndex(float InCellSize = 1000.f)
+		: CellSize(FMath::Max<float>(InCellSize, 1.f))
+	{}
+
+	float CellSize;
+
+	/** Entries are never moved, removed entries are reused */
+	TArray<FDoorSpatialEntry> Entries;
+	TArray<int32> FreeEntries;
+
+	/** Entry indices in each occupied cell */
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<8>>> Cells;
+
+	FIntPoint GetCell(const FVector& Location) const
+	{
+		return { FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize) };
+	}
+
+	int32 Add(ADoor* Door, const FVector& Location, EDoorState DoorState, EDoorDirection DoorDirection);
+	void Remove(int32 Index);
+	void Update(int32 Index, const FVector& Location, EDoorState DoorState, EDoorDirection DoorDirection);
+
+	/**
+	 * Call Func(const FDoorSpatialEntry& Entry, int32 Index, double DistSquared) for every door within Radius
+	 * Never visits more cells than there are doors, larger radii test every door directly
+	 * @param StateMask Only doors in these states, see DoorSpatialStateMask()
+	 */
+	template<typename FuncType>
+	void ForEachInRadius(const FVector& Origin, float Radius, uint8 StateMask, FuncType&& Func) const;
+
+	/** Doors within Radius of Origin, in no particular order */
+	int32 QueryRadius(const FVector& Origin, float Radius, TArray<int32>& OutIndices, uint8 StateMask = DoorSpatialAllStates) const;
+
+	/** Up to K doors within MaxRadius of Origin, nearest first */
+	int32 QueryNearest(const FVector& Origin, int32 K, float MaxRadius, TArray<int32>& OutIndices, uint8 StateMask = DoorSpatialAllStates) const;
+
+	/** Doors within MaxDistance of Origin that are inside the frustum, e.g. the view frustum */
+	int32 QueryFrustum(const FConvexVolume& Frustum, const FVector& Origin, float MaxDistance, TArray<int32>& OutIndices,
+		uint8 StateMask = DoorSpatialAllStates) const;
+};
+
+template <typename FuncType>
+void FDoorSpatialIndex::ForEachInRadius(const FVector& Origin, float Radius, uint8 StateMask, FuncType&& Func) const
+{
+	const double RadiusSquared = FMath::Square<double>(Radius);
+
+	// Large radii would visit more empty cells than there are doors, test every door instead
+	// Computed in double so that huge radii can't overflow the cell coordinates
+	const double CellsPerAxis = 2.0 * Radius / CellSize + 2.0;
+	if (CellsPerAxis * CellsPerAxis > Entries.Num() - FreeEntries.Num())
+	{
+		for (int32 Index = 0; Index < Entries.Num(); Index++)
+		{
+			const FDoorSpatialEntry& Entry = Entries[Index];
+			if (!Entry.bValid || (StateMask & DoorSpatialStateMask(Entry.DoorState)) == 0)
+			{
+				continue;
+			}
+
+			const double DistSquared = FVector::DistSquared(Origin, Entry.Location);
+			if (DistSquared <= RadiusSquared)
+			{
+				Func(Entry, Index, DistSquared);
+			}
+		}
+		return;
+	}
+
+	const FIntPoint Min = GetCell(Origin - FVector(Radius));
+	const FIntPoint Max = GetCell(Origin + FVector(Radius));
+
+	for (int32 X = Min.X; X <= Max.X; X++)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+		{
+			const TArray<int32, TInlineAllocator<8>>* Cell = Cells.Find({ X, Y });
+			if (!Cell)
+			{
+				continue;
+			}
+			
+			for (const int32 Index : *Cell)
+			{
+				const FDoorSpatialEntry& Entry = Entries[Index];
+				if ((StateMask & DoorSpatialStateMask(Entry.DoorState)) == 0)
+				{
+					continue;
+				}
+				
+				const double DistSquared = FVector::DistSquared(Origin, Entry.Location);
+				if (DistSquared <= RadiusSquared)
+				{
+					Func(Entry, Index, DistSquared);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Spatial index of every door in the world, for finding nearby doors without physics queries or actor iteration
+ * Doors register themselves and update the index when they move or change state
+ *
+ * Queries on the game thread can use the live index, worker threads must use GetSnapshot()
+ */
+UCLASS()
+class DOORS_API UDoorSpatialSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	FDoorSpatialIndex Index;
+	TMap<TObjectKey<ADoor>, int32> DoorIndices;
+
+	/** Immutable copy of the index for worker threads, rebuilt on request after the index changes */
+	mutable TSharedPtr<const FDoorSpatialIndex, ESPMode::ThreadSafe> Snapshot;
+	mutable bool bSnapshotDirty = true;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+public:
+	void RegisterDoor(ADoor* Door);
+	void UnregisterDoor(ADoor* Door);
+
+	/** Refresh the door's location and state */
+	void UpdateDoor(ADoor* Door);
+
+	/** The live index, only valid on the game thread */
+	const FDoorSpatialIndex& GetIndex() const { return Index; }
+
+	/**
+	 * Immutable copy of the index that can be read from any thread
+	 * Call on the game thread and hand the result to the worker
+	 */
+	TSharedRef<const FDoorSpatialIndex, ESPMode::ThreadSafe> GetSnapshot() const;
+
+	/** Doors within Radius of Origin, in no particular order */
+	int32 QueryRadius(const FVector& Origin, float Radius, TArray<ADoor*>& OutDoors, uint8 StateMask = DoorSpatialAllStates) const;
+
+	/** Up to K doors within MaxRadius of Origin, nearest first */
+	int32 QueryNearest(const FVector& Origin, int32 K, float MaxRadius, TArray<ADoor*>& OutDoors, uint8 StateMask = DoorSpatialAllStates) const;
+
+	/** Doors within MaxDistance of Origin that are inside the frustum, e.g. the view frustum */
+	int32 QueryFrustum(const FConvexVolume& Frustum, const FVector& Origin, float MaxDistance, TArray<ADoor*>& OutDoors,
+		uint8 StateMask = DoorSpatialAllStates) const;
+
+	/** Doors in the given state within Radius of Origin */
+	int32 QueryRadiusInState(const FVector& Origin, float Radius, EDoorState State, TArray<ADoor*>& OutDoors) const
+	{
+		return QueryRadius(Origin, Radius, OutDoors, DoorSpatialStateMask(State));
+	}
+
+protected:
+	/** Resolve entry indices to doors, reusing the scratch array */
+	int32 ResolveDoors(const TArray<int32>& Indices, TArray<ADoor*>& OutDoors) const;
+	
+	mutable TArray<int32> ScratchIndices;
+};
@@ -0,0 +1,113 @@
+﻿// Copyright (c) Jared Taylor
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DoorTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DoorTraversalSubsystem.generated.h"
+
+class ADoor;
+class UPathFollowingComponent;
+
+/**
+ * An agent waiting to pass through a door
+ */
+struct FDoorTraversalAgent
+{
+	TWeakObjectPtr<AActor> Agent;
+
+	/** The side the agent is passing from, the agent has passed through once it is on the other side */
+	EDoorSide FromSide = EDoorSide::Front;
+
+	/** When the agent was queued, agents that wait too long are dropped */
+	float QueueTime = 0.f;
+
+	/** Path following of the agent's move through the door, if it is moving along a nav link */
+	TWeakObjectPtr<UPathFollowingComponent> PathFollowing;
+
+	/** Bound to PathFollowing's OnRequestFinished, the agent leaves the queue when its move ends */
+	FDelegateHandle MoveFinishedHandle;
+
+	/** True if we paused the agent's move until the door is open */
+	bool bPaused = false;
+};
+
+/**
+ * Agents waiting to pass through a single door, oldest first
+ */
+struct FDoorTraversalQueue
+{
+	TArray<FDoorTraversalAgent, TInlineAllocator<8>> Agents;
+
+	/** When the queue last became empty, used to close the door behind the agents */
+	float DrainedTime = -1.f;
+
+	/** True if we opened the door, we only close doors we opened */
+	bool bOpenedForTraversal = false;
+};
+
+/**
+ * Server-side coordinator for AI agents passing through doors
+ *
+ * Rather than each agent interacting with the door separately and fighting over its state, agents are queued per door
+ * and a single decision is made for the whole queue at p.Door.Traversal.DecisionRate. The interaction is evaluated once
+ * per side of the door with agents waiting on it, at most one SetDoorState() is issued per decision, and the door is
+ * held open until the queue drains
+ *
+ * Agents are queued automatically when they start using a door's UDoorNavLinkComponent. Their path following is
+ * paused until the door is open, and they leave the queue once they are on the other side of the door or their move
+ * ends
+ */
+UCLASS()
+class DOORS_API UDoorTraversalSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	TMap<TWeakObjectPtr<ADoor>, FDoorTraversalQueue> DoorQueues;
+
+	float LastDecisionTime = -1.f;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override;
+
+public:
+	/**
+	 * Queue an agent to pass through the door from the side it is currently on
+	 * Does nothing if the agent is already queued for this door
+	 * @param PathFollowing If provided, the agent's move is paused until the door is open, and the agent leaves the
+	 *	queue when the move ends
+	 */
+	void EnqueueAgent(AActor* Agent, ADoor* Door, UPathFollowingComponent* PathFollowing = nullptr);
+
+	/** Remove the agent from the door's queue, e.g. when the agent's path changes, resuming its move if we paused it */
+	void DequeueAgent(const AActor* Agent, const ADoor* Door);
+
+	/** @return Number of agents waiting to pass through the door */
+	int32 GetNumQueuedAgents(const ADoor* Door) const;
+
+	/** @return True if agents are waiting to pass through the door, any auto-close logic should wait */
+	bool IsDoorHeldOpen(const ADoor* Door) const { return GetNumQueuedAgents(Door) > 0; }
+
+protected:
+	/** Remove agents that passed through, no longer exist, or waited too long */
+	void UpdateQueue(const ADoor* Door, FDoorTraversalQueue& Queue, float TimeSeconds,
+		TArray<FDoorTraversalAgent>& OutReleasedAgents);
+
+	/**
+	 * Stop tracking the agent's move, if we paused it then resume it, or abort it so the agent can find another path
+	 * Path following may call back into the subsystem, never call while iterating the queues
+	 */
+	void ReleaseAgent(FDoorTraversalAgent& Queued, bool bResume);
+
+	/** Decide what the door should do for the queue, issuing at most one SetDoorState() */
+	void DecideForQueue(ADoor* Door, FDoorTraversalQueue& Queue, float TimeSeconds);
+};